@@ -40,6 +40,10 @@ function (setup_agent _srcs  _inputs)
 
    target_link_libraries( ${_exe_name} amrex )
 
+   # the daily summary is written from a background thread (see ExaEpi::IO::DailySummaryWriter)
+   find_package( Threads REQUIRED )
+   target_link_libraries( ${_exe_name} Threads::Threads )
+
    if (AMReX_CUDA)
       setup_target_for_cuda_compilation( ${_exe_name} )
    endif ()
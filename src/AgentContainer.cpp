@@ -156,6 +156,263 @@ namespace {
         ParallelDescriptor::Bcast(&cell_indices[0], cell_indices.size(),
                                   ParallelDescriptor::IOProcessorNumber());
     }
+
+    /*! \brief Community-wise disease statistics (components of the MultiFabs passed to
+        AgentContainer::updateStatus()); the first #DiseaseParm::num_treatment_levels components
+        are the treatment levels, in the order of DiseaseParm::treatment_prob */
+    struct DiseaseStats
+    {
+        enum {
+            hospitalization = 0,
+            ICU,
+            ventilator,
+            death,
+            ncomp
+        };
+    };
+
+    /*! \brief Change of the community-wise disease stats (#DiseaseStats) caused by the daily
+        disease progression of an agent; encoded as kind + (treatment level << level_shift),
+        where the treatment level is that of DiseaseParm::treatment_prob */
+    struct StatsEvent
+    {
+        enum {
+            none = 0,   /*!< no change */
+            admitted,   /*!< hospitalized, up to the treatment level */
+            discharged, /*!< recovered at the end of the hospital stay */
+            died        /*!< died at the end of the hospital stay */
+        };
+
+        static constexpr int level_shift = 2;
+
+        /*! \brief Encode an event */
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        static int make ( const int a_kind, /*!< kind of event */
+                          const int a_level /*!< treatment level */ )
+        {
+            return a_kind | (a_level << level_shift);
+        }
+    };
+
+    /*! \brief Add the disease stats events of the agents of a tile to the community-wise
+        disease stats
+
+        The events (#StatsEvent) are compacted, sorted by the home community of the agents,
+        and each community then adds up its own events, so that no atomic updates are needed.
+        Under OpenMP, each tile only adds events of its own agents, whose home communities are
+        in the tile (agents are at home during the status update); the events are binned over
+        the cells of the tile box only, so the cost is proportional to the tile.
+    */
+    template <typename F>
+    void addDiseaseStats ( const int           a_n,      /*!< number of events */
+                           const int* const    a_events, /*!< events (#StatsEvent) */
+                           F const&            a_agent,  /*!< agent index of an event */
+                           const int* const    a_home_i, /*!< home location index of agents */
+                           const int* const    a_home_j, /*!< home location index of agents */
+                           const Box&          a_box,    /*!< tile box of the disease stats */
+                           const Array4<Real>& a_ds_arr  /*!< community-wise disease stats */ )
+    {
+        BL_PROFILE("addDiseaseStats");
+        if (a_n <= 0) { return; }
+
+        Gpu::DeviceVector<int> items(a_n);
+        auto items_ptr = items.data();
+        const int nitems = Scan::PrefixSum<int>(a_n,
+            [=] AMREX_GPU_DEVICE (int k) -> int
+            {
+                return (a_events[k] != StatsEvent::none) ? 1 : 0;
+            },
+            [=] AMREX_GPU_DEVICE (int k, int const& s)
+            {
+                if (a_events[k] != StatsEvent::none) { items_ptr[s] = k; }
+            },
+            Scan::Type::exclusive, Scan::retSum);
+        if (nitems == 0) { return; }
+
+        const auto ncells = static_cast<int>(a_box.numPts());
+        DenseBins<int> bins;
+        bins.build(BinPolicy::Serial, nitems, items_ptr, ncells,
+                   [=] AMREX_GPU_HOST_DEVICE (int k) noexcept -> unsigned int
+                   {
+                       const int i = a_agent(k);
+                       IntVect iv(AMREX_D_DECL(a_home_i[i], a_home_j[i], 0));
+                       iv.max(a_box.smallEnd());
+                       iv.min(a_box.bigEnd());
+                       return static_cast<unsigned int>(a_box.index(iv));
+                   });
+        auto perm = bins.permutationPtr();
+        auto offsets = bins.offsetsPtr();
+
+        ParallelFor( ncells, [=] AMREX_GPU_DEVICE (int c) noexcept
+        {
+            const auto start = offsets[c];
+            const auto stop = offsets[c+1];
+            if (start == stop) { return; }
+
+            Real delta[DiseaseStats::ncomp] = {};
+            for (auto p = start; p < stop; ++p) {
+                const int event = a_events[items_ptr[perm[p]]];
+                const int kind = event & ((1 << StatsEvent::level_shift) - 1);
+                const int level = event >> StatsEvent::level_shift;
+                const Real sign = (kind == StatsEvent::admitted) ? 1.0_rt : -1.0_rt;
+                for (int l = 0; l <= level; l++) {
+                    delta[DiseaseStats::hospitalization+l] += sign;
+                }
+                if (kind == StatsEvent::died) { delta[DiseaseStats::death] += 1.0_rt; }
+            }
+            const IntVect iv = a_box.atOffset(c);
+            for (int n = 0; n < DiseaseStats::ncomp; n++) {
+                if (delta[n] != 0.0_rt) { a_ds_arr(iv, n) += delta[n]; }
+            }
+        });
+        Gpu::synchronize();
+    }
+
+    /*! \brief Daily disease progression of the agents of a tile, for one disease
+
+        Advances the disease of an infected or immune agent by one day (see
+        AgentContainer::updateStatus()); used by both the daily sweep over all agents and the
+        event calendar. Returns the change of the community-wise disease stats (#StatsEvent),
+        which the callers add up with addDiseaseStats().
+    */
+    struct DiseaseProgression
+    {
+        int* traits_ptr;                        /*!< traits of agents */
+        int* state_ptr;                         /*!< disease state of agents */
+        int* clock_ptr;                         /*!< disease clock of agents */
+        const int* schedule_ptr;                /*!< disease transition days of agents */
+        const DiseaseParm* lparm;               /*!< disease parameters (device) */
+        int symptomatic_withdraw;               /*!< do symptomatic agents withdraw? */
+        Real symptomatic_withdraw_compliance;   /*!< compliance of symptomatic agents with withdrawal */
+        Real mean_immune_time;                  /*!< mean immunity time (days) */
+        Real immune_time_spread;                /*!< spread of immunity time (days) */
+        bool nearest_day_rounding;              /*!< round immunity time to the nearest day? */
+
+        /*! \brief Advance the disease of agent i by one day; the agent must be
+                   #Status::infected or #Status::immune */
+        AMREX_GPU_DEVICE
+        int operator() ( const int i, /*!< agent index */
+                         AgentRNG& rng /*!< random number generator */ ) const
+        {
+            const int status = DiseaseState::status::get(state_ptr[i]);
+            if (status == Status::immune) {
+                int counter = DiseaseClock::counter::get(clock_ptr[i]) - 1;
+                DiseaseClock::counter::set(clock_ptr[i], amrex::max(counter, 0));
+                if (counter < 0) {
+                    AgentTraits::treatment_timer::set(traits_ptr[i], 0);
+                    DiseaseState::status::set(state_ptr[i], Status::susceptible);
+                }
+                return StatsEvent::none;
+            }
+            if (status != Status::infected) { return StatsEvent::none; }
+
+            const int counter = DiseaseClock::counter::get(clock_ptr[i]) + 1;
+            DiseaseClock::counter::set(clock_ptr[i], counter);
+            if (counter == 1) {
+                DiseaseState::symptomatic::set(state_ptr[i],
+                                               (rng.random() < lparm->p_asymp[0])
+                                               ? SymptomStatus::asymptomatic
+                                               : SymptomStatus::presymptomatic);
+            }
+            if (counter == DiseaseClock::symptomdev_day::get(clock_ptr[i])) {
+                if (DiseaseState::symptomatic::get(state_ptr[i]) != SymptomStatus::asymptomatic) {
+                    DiseaseState::symptomatic::set(state_ptr[i], SymptomStatus::symptomatic);
+                    if (    (symptomatic_withdraw)
+                        &&  (rng.random() < symptomatic_withdraw_compliance)) {
+                        AgentTraits::withdrawn::set(traits_ptr[i], 1);
+                    }
+                }
+            }
+
+            const int infectious_day = DiseaseSchedule::infectious_day::get(schedule_ptr[i]);
+            if (counter < infectious_day) { return StatsEvent::none; } // incubation phase
+
+            const int age_group = AgentTraits::age_group::get(traits_ptr[i]);
+            if (counter == infectious_day) {
+                // decide if hospitalized, for how long, and up to which treatment level
+                if (rng.random() < lparm->treatment_prob[0][age_group]) {
+                    const Real short_frac = lparm->hospital_short_frac[age_group];
+                    const int length = ((short_frac < 1.0_rt) && (rng.random() >= short_frac)) ? 1 : 0;
+                    int level = 0;
+                    while (    (level+1 < DiseaseParm::num_treatment_levels)
+                            && (rng.random() < lparm->treatment_prob[level+1][age_group])) {
+                        ++level;
+                    }
+                    AgentTraits::treatment_timer::set(traits_ptr[i],
+                                                      lparm->hospital_days[length][age_group]
+                                                      + level*DiseaseParm::treatment_level_days);
+                    return StatsEvent::make(StatsEvent::admitted, level);
+                }
+                return StatsEvent::none;
+            }
+
+            const int timer = AgentTraits::treatment_timer::get(traits_ptr[i]) - 1;
+            if (timer >= 0) {
+                // do hospital things: discharge (dead or recovered) at the end of the stay
+                AgentTraits::treatment_timer::set(traits_ptr[i], timer);
+                if (timer % DiseaseParm::treatment_level_days != 0) { return StatsEvent::none; }
+                const int level = timer / DiseaseParm::treatment_level_days;
+                AgentTraits::treatment_timer::set(traits_ptr[i], 0); // discharged
+                const Real p_death = lparm->treatment_death_prob[level][age_group];
+                if ((p_death > 0.0_rt) && (rng.random() < p_death)) {
+                    DiseaseState::status::set(state_ptr[i], Status::dead);
+                    return StatsEvent::make(StatsEvent::died, level);
+                }
+                recover(i, rng);  // If alive, hospitalized patient recovers
+                return StatsEvent::make(StatsEvent::discharged, level);
+            }
+            if (counter >= DiseaseSchedule::recovery_day::get(schedule_ptr[i])) {
+                // not hospitalized, recover once not infectious
+                recover(i, rng);
+            }
+            return StatsEvent::none;
+        }
+
+        /*! \brief Make agent i immune */
+        AMREX_GPU_DEVICE
+        void recover ( const int i, /*!< agent index */
+                       AgentRNG& rng /*!< random number generator */ ) const
+        {
+            DiseaseState::status::set(state_ptr[i], Status::immune);
+            DiseaseClock::counter::set(clock_ptr[i], immuneDays(mean_immune_time, immune_time_spread,
+                                                                nearest_day_rounding, rng));
+            DiseaseState::symptomatic::set(state_ptr[i], SymptomStatus::presymptomatic);
+            AgentTraits::withdrawn::set(traits_ptr[i], 0);
+        }
+    };
+
+    /*! \brief Infection of the agents of a tile, for one disease (see
+        AgentContainer::infectAgents()) */
+    struct DiseaseInfection
+    {
+        int* state_ptr;                         /*!< disease state of agents */
+        int* clock_ptr;                         /*!< disease clock of agents */
+        int* schedule_ptr;                      /*!< disease transition days of agents */
+        const DiseaseParm* lparm;               /*!< disease parameters (device) */
+
+        /*! \brief Infect agent i with probability a_p_infect if it is #Status::never or
+                   #Status::susceptible, and draw its disease periods; returns true if the
+                   agent got infected */
+        AMREX_GPU_DEVICE
+        bool operator() ( const int i, /*!< agent index */
+                          const ParticleReal a_p_infect, /*!< infection probability */
+                          AgentRNG& rng /*!< random number generator */ ) const
+        {
+            if ( DiseaseState::status::get(state_ptr[i]) == Status::never ||
+                 DiseaseState::status::get(state_ptr[i]) == Status::susceptible ) {
+                if (rng.random() < a_p_infect) {
+                    DiseaseState::status::set(state_ptr[i], Status::infected);
+                    auto incubation_period = static_cast<ParticleReal>(rng.random_normal(lparm->incubation_length_mean, lparm->incubation_length_std));
+                    auto infectious_period = static_cast<ParticleReal>(rng.random_normal(lparm->infectious_length_mean, lparm->infectious_length_std));
+                    auto symptomdev_period = static_cast<ParticleReal>(rng.random_normal(lparm->symptomdev_length_mean, lparm->symptomdev_length_std));
+                    startDiseaseClock(clock_ptr[i], schedule_ptr[i], incubation_period, infectious_period,
+                                      symptomdev_period, lparm->nearest_day_rounding);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
 }
 
 /*! Add runtime SoA attributes */
@@ -189,6 +446,8 @@ void AgentContainer::initAgentsDemo (iMultiFab& /*num_residents*/,
                                      DemographicData& /*demo*/)
 {
     BL_PROFILE("AgentContainer::initAgentsDemo");
+    // demo agents are numbered per rank, so their generator keys would not be unique
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_counter_rng, "agent.counter_rng needs ic_type = census");
 
     int ncell = 3000;
     Vector<int> cell_pops;
@@ -241,17 +500,29 @@ void AgentContainer::initAgentsDemo (iMultiFab& /*num_residents*/,
     auto pstruct_ptr = aos().data();
 
     int i_RT = IntIdx::nattribs;
-    int r_RT = RealIdx::nattribs;
     int n_disease = m_num_diseases;
 
-    GpuArray<int*,ExaEpi::max_num_diseases> status_ptrs, strain_ptrs;
-    GpuArray<ParticleReal*,ExaEpi::max_num_diseases> counter_ptrs;
+    int r_RT = RealIdx::nattribs;
+
+    GpuArray<int*,ExaEpi::max_num_diseases> state_ptrs, clock_ptrs, schedule_ptrs;
+    GpuArray<ParticleReal*,ExaEpi::max_num_diseases> prob_ptrs;
     for (int d = 0; d < n_disease; d++) {
-        status_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::status).data();
-        strain_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::strain).data();
-        counter_ptrs[d] = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::disease_counter).data();
+        state_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+        clock_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+        schedule_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+        prob_ptrs[d] = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
     }
 
+    auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
+    auto family_ptr = soa.GetIntData(IntIdx::family).data();
+    auto home_i_ptr = soa.GetIntData(IntIdx::home_i).data();
+    auto home_j_ptr = soa.GetIntData(IntIdx::home_j).data();
+    auto work_i_ptr = soa.GetIntData(IntIdx::work_i).data();
+    auto work_j_ptr = soa.GetIntData(IntIdx::work_j).data();
+    auto nborhood_ptr = soa.GetIntData(IntIdx::nborhood).data();
+    auto workgroup_ptr = soa.GetIntData(IntIdx::workgroup).data();
+    auto work_nborhood_ptr = soa.GetIntData(IntIdx::work_nborhood).data();
+
     auto cell_offsets_ptr = cell_offsets_d.data();
     auto cell_indices_ptr = cell_indices_d.data();
 
@@ -273,15 +544,26 @@ void AgentContainer::initAgentsDemo (iMultiFab& /*num_residents*/,
             p.pos(1) = idy + 0.5_rt;
             p.id() = i;
             p.cpu() = 0;
+            traits_ptr[i] = 0;
+            family_ptr[i] = i;  // each demo agent is its own family
+            home_i_ptr[i] = idx;
+            home_j_ptr[i] = idy;
+            work_i_ptr[i] = idx;
+            work_j_ptr[i] = idy;
+            nborhood_ptr[i] = 0;
+            workgroup_ptr[i] = 0;
+            work_nborhood_ptr[i] = 0;
 
             for (int d = 0; d < n_disease; d++) {
-                counter_ptrs[d][i] = 0.0_rt;
-                strain_ptrs[d][i] = 0;
+                state_ptrs[d][i] = 0;
+                clock_ptrs[d][i] = 0;
+                schedule_ptrs[d][i] = 0;
+                prob_ptrs[d][i] = 1.0_prt;
 
                 if (amrex::Random(engine) < 1e-6) {
-                    status_ptrs[d][i] = 1;
+                    DiseaseState::status::set(state_ptrs[d][i], 1);
                     if (amrex::Random(engine) < 0.3) {
-                        strain_ptrs[d][i] = 1;
+                        DiseaseState::strain::set(state_ptrs[d][i], 1);
                     }
                 }
             }
@@ -325,7 +607,7 @@ void AgentContainer::initAgentsDemo (iMultiFab& /*num_residents*/,
  *      + Find age group by generating a random integer (0-100) and using default age distributions.
  *        Look at code to see the algorithm for family size > 1.
  *      + Set agent position at the center of this grid cell.
- *      + Initialize status and day counters.
+ *      + Initialize status, day counters, and infection probabilities.
  *      + Set age group and family ID.
  *      + Set home location to current grid cell.
  *      + Initialize work location to current grid cell. Actual work location is set in
@@ -396,12 +678,15 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
         //auto N65plus = demo.N65plus_d.data();
 
         auto Ncommunity = demo.Ncommunity;
+        const bool counter_rng = m_counter_rng;
 
         auto bx = mfi.tilebox();
         amrex::ParallelForRNG(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k, amrex::RandomEngine const& engine) noexcept
         {
             int community = (int) domain.index(IntVect(AMREX_D_DECL(i, j, k)));
             if (community >= Ncommunity) { return; }
+            AgentRNG rng = counter_rng ? AgentRNG(community, 0, RNGStream::family_sizes, 0)
+                                       : AgentRNG(engine);
             comm_arr(i, j, k) = community;
 
             int unit = 0;
@@ -436,7 +721,7 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
 
             int npeople = 0;
             while (npeople < community_size + 1) {
-                int il  = amrex::Random_int(1000, engine);
+                int il  = rng.random_int(1000);
 
                 int family_size = 1;
                 while (il > p_hh[family_size]) { ++family_size; }
@@ -454,6 +739,9 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
                          5*nf_arr(i, j, k, 4) +
                          6*nf_arr(i, j, k, 5) +
                          7*nf_arr(i, j, k, 6));
+            // with counter_rng, the agent ids hold the index in the cell in 16 bits
+            AMREX_ALWAYS_ASSERT(!counter_rng || npeople < (1 << 16));
+            AMREX_ASSERT(npeople < (1 << 16));
 
             nr_arr(i, j, k, 5) = npeople;
         });
@@ -492,29 +780,30 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
         auto aos = &agents_tile.GetArrayOfStructs()[0];
         auto& soa = agents_tile.GetStructOfArrays();
 
-        auto age_group_ptr = soa.GetIntData(IntIdx::age_group).data();
+        auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
         auto family_ptr = soa.GetIntData(IntIdx::family).data();
         auto home_i_ptr = soa.GetIntData(IntIdx::home_i).data();
         auto home_j_ptr = soa.GetIntData(IntIdx::home_j).data();
         auto work_i_ptr = soa.GetIntData(IntIdx::work_i).data();
         auto work_j_ptr = soa.GetIntData(IntIdx::work_j).data();
         auto nborhood_ptr = soa.GetIntData(IntIdx::nborhood).data();
-        auto school_ptr = soa.GetIntData(IntIdx::school).data();
         auto workgroup_ptr = soa.GetIntData(IntIdx::workgroup).data();
         auto work_nborhood_ptr = soa.GetIntData(IntIdx::work_nborhood).data();
 
         int i_RT = IntIdx::nattribs;
-        int r_RT = RealIdx::nattribs;
         int n_disease = m_num_diseases;
 
-        GpuArray<int*,ExaEpi::max_num_diseases> status_ptrs;
-        GpuArray<ParticleReal*,ExaEpi::max_num_diseases> counter_ptrs;
+        int r_RT = RealIdx::nattribs;
+
+        GpuArray<int*,ExaEpi::max_num_diseases> state_ptrs, clock_ptrs, schedule_ptrs;
+        GpuArray<ParticleReal*,ExaEpi::max_num_diseases> prob_ptrs;
         for (int d = 0; d < n_disease; d++) {
-            status_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::status).data();
-            counter_ptrs[d] = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::disease_counter).data();
+            state_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+            clock_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+            schedule_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+            prob_ptrs[d] = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
         }
 
-        auto timer_ptr = soa.GetRealData(RealIdx::treatment_timer).data();
         auto dx = ParticleGeom(0).CellSizeArray();
         auto my_proc = ParallelDescriptor::MyProc();
 
@@ -529,12 +818,23 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
             static_cast<Long>(pid + nagents) < LastParticleID,
             "Error: overflow on agent id numbers!");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !counter_rng || (static_cast<Long>(domain.numPts()) << 16) < LastParticleID,
+            "Error: overflow on agent id numbers!");
 
         amrex::ParallelForRNG(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n, amrex::RandomEngine const& engine) noexcept
         {
             int nf = nf_arr(i, j, k, n);
             if (nf == 0) return;
 
+            /* with the counter-based generator, the agents are keyed by their grid cell and
+               their index in it, and so do not depend on the domain decomposition */
+            const auto cell = static_cast<Long>(domain.index(IntVect(AMREX_D_DECL(i, j, k))));
+            AgentRNG rng = counter_rng ? AgentRNG(cell, 0, RNGStream::agent_traits, n)
+                                       : AgentRNG(engine);
+            int cell_start = 0;
+            for (int nn = 0; nn < n; ++nn) { cell_start += (nn+1)*nf_arr(i, j, k, nn); }
+
             int unit = unit_arr(i, j, k);
             int community = comm_arr(i, j, k);
             int family_id_start = fam_id_arr(i, j, k, n);
@@ -564,9 +864,9 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
             for (int ii = 0; ii < num_to_add; ++ii) {
                 int ip = start + ii;
                 auto& agent = aos[ip];
-                int il2 = amrex::Random_int(100, engine);
+                int il2 = rng.random_int(100);
                 if (ii % family_size == 0) {
-                    nborhood = amrex::Random_int(4, engine);
+                    nborhood = rng.random_int(4);
                 }
                 int age_group = -1;
 
@@ -578,12 +878,12 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
                 } else if (family_size == 2) {
                     if (il2 == 0) {
                         /* 1% probability of one parent + one child */
-                        int il3 = amrex::Random_int(100, engine);
+                        int il3 = rng.random_int(100);
                         if (il3 < 2) { age_group = 4; }        /* one parent, age 65+ */
                         else if (il3 < 62) { age_group = 3; }  /* one parent 30-64 (ASSUME 60%) */
                         else { age_group = 2; }                /* one parent 19-29 */
                         nr_arr(i, j, k, age_group) += 1;
-                        if (((int) amrex::Random_int(100, engine)) < p_schoolage) {
+                        if (((int) rng.random_int(100)) < p_schoolage) {
                             age_group = 1; /* 22.0% of total population ages 5-18 */
                         } else {
                             age_group = 0;   /* 6.8% of total population ages 0-4 */
@@ -607,7 +907,7 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
 
                     /* Now pick the children's age groups */
                     for (int nc = 2; nc < family_size; ++nc) {
-                        if (((int) amrex::Random_int(100, engine)) < p_schoolage) {
+                        if (((int) rng.random_int(100)) < p_schoolage) {
                             age_group = 1; /* 22.0% of total population ages 5-18 */
                         } else {
                             age_group = 0;   /* 6.8% of total population ages 0-4 */
@@ -618,15 +918,22 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
 
                 agent.pos(0) = (i + 0.5_rt)*dx[0];
                 agent.pos(1) = (j + 0.5_rt)*dx[1];
-                agent.id()  = pid+ip;
-                agent.cpu() = my_proc;
+                if (counter_rng) {
+                    agent.id()  = (cell << 16) + cell_start + ii;
+                    agent.cpu() = 0;
+                } else {
+                    agent.id()  = pid+ip;
+                    agent.cpu() = my_proc;
+                }
 
                 for (int d = 0; d < n_disease; d++) {
-                    status_ptrs[d][ip] = 0;
-                    counter_ptrs[d][ip] = 0.0_rt;
+                    state_ptrs[d][ip] = 0;
+                    clock_ptrs[d][ip] = 0;
+                    schedule_ptrs[d][ip] = 0;
+                    prob_ptrs[d][ip] = 1.0_prt;
                 }
-                timer_ptr[ip] = 0.0_rt;
-                age_group_ptr[ip] = age_group;
+                traits_ptr[ip] = 0;
+                AgentTraits::age_group::set(traits_ptr[ip], age_group);
                 family_ptr[ip] = family_id_start + (ii / family_size);
                 home_i_ptr[ip] = i;
                 home_j_ptr[ip] = j;
@@ -637,11 +944,11 @@ void AgentContainer::initAgentsCensus (iMultiFab& num_residents,    /*!< Number
                 workgroup_ptr[ip] = 0;
 
                 if (age_group == 0) {
-                    school_ptr[ip] = 5; // note - need to handle playgroups
+                    AgentTraits::school::set(traits_ptr[ip], 5); // note - need to handle playgroups
                 } else if (age_group == 1) {
-                    school_ptr[ip] = assign_school(nborhood, engine);
+                    AgentTraits::school::set(traits_ptr[ip], assign_school(nborhood, rng));
                 } else {
-                    school_ptr[ip] = -1;
+                    AgentTraits::school::set(traits_ptr[ip], -1);
                 }
 
             }
@@ -690,86 +997,140 @@ void AgentContainer::moveAgentsRandomWalk ()
 
 /*! \brief Move agents to work
 
-    For each agent, set its position to the work community (IntIdx::work_i, IntIdx::work_j)
+    Home and work locations do not change, and the interaction models use the bins of agents
+    by work community (see InteractionModel::makeBins()) while agents are at work; so, only
+    the location flag is set, and agent positions are left at the home location.
 */
 void AgentContainer::moveAgentsToWork ()
 {
     BL_PROFILE("AgentContainer::moveAgentsToWork");
-
-    for (int lev = 0; lev <= finestLevel(); ++lev)
-    {
-        const auto dx = Geom(lev).CellSizeArray();
-        auto& plev  = GetParticles(lev);
-
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-        for(MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
-        {
-            int gid = mfi.index();
-            int tid = mfi.LocalTileIndex();
-            auto& ptile = plev[std::make_pair(gid, tid)];
-            auto& aos   = ptile.GetArrayOfStructs();
-            ParticleType* pstruct = &(aos[0]);
-            const size_t np = aos.numParticles();
-
-            auto& soa = ptile.GetStructOfArrays();
-            auto work_i_ptr = soa.GetIntData(IntIdx::work_i).data();
-            auto work_j_ptr = soa.GetIntData(IntIdx::work_j).data();
-
-            amrex::ParallelFor( np,
-            [=] AMREX_GPU_DEVICE (int ip) noexcept
-            {
-                ParticleType& p = pstruct[ip];
-                p.pos(0) = (work_i_ptr[ip] + 0.5_prt)*dx[0];
-                p.pos(1) = (work_j_ptr[ip] + 0.5_prt)*dx[1];
-            });
-        }
-    }
-
     m_at_work = true;
 }
 
 /*! \brief Move agents to home
 
-    For each agent, set its position to the home community (IntIdx::home_i, IntIdx::home_j)
+    Sets the location flag back to home (see AgentContainer::moveAgentsToWork()).
 */
 void AgentContainer::moveAgentsToHome ()
 {
     BL_PROFILE("AgentContainer::moveAgentsToHome");
+    m_at_work = false;
+}
+
+/*! \brief Sort agents in memory by home community, neighborhood, and family
+
+    Physically reorders all the components (AoS and SoA) of the agents of each tile, so that
+    agents that interact at home and in their home community are contiguous in memory; the
+    bins of agents by home community (see InteractionModel::makeBins()) are then in memory
+    order, and the attribute reads of the interaction kernels are no longer scattered.
+
+    The permutation is computed with two stable (serial) binning passes: by family, then by
+    home community and neighborhood. Bins and lists of agents cached for each tile refer to
+    agent indices, so they are discarded and rebuilt when next needed; the agent indices of
+    the scheduled disease transitions (see #DiseaseCalendar) are updated.
+*/
+void AgentContainer::sortAgents ()
+{
+    BL_PROFILE("AgentContainer::sortAgents");
 
     for (int lev = 0; lev <= finestLevel(); ++lev)
     {
-        const auto dx = Geom(lev).CellSizeArray();
-        auto& plev  = GetParticles(lev);
-
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
         for(MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
         {
-            int gid = mfi.index();
-            int tid = mfi.LocalTileIndex();
-            auto& ptile = plev[std::make_pair(gid, tid)];
-            auto& aos   = ptile.GetArrayOfStructs();
-            ParticleType* pstruct = &(aos[0]);
-            const size_t np = aos.numParticles();
+            auto& ptile = ParticlesAt(lev, mfi);
+            const auto& ptd = ptile.getParticleTileData();
+            const auto np = static_cast<int>(ptile.numParticles());
+            if (np == 0) { continue; }
+
+            auto family_ptr = ptd.m_idata[IntIdx::family];
+            auto nborhood_ptr = ptd.m_idata[IntIdx::nborhood];
+
+            ReduceOps<ReduceOpMin, ReduceOpMax, ReduceOpMax> reduce_op;
+            ReduceData<int, int, int> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(np, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i) -> ReduceTuple
+            {
+                return { family_ptr[i], family_ptr[i], nborhood_ptr[i] };
+            });
+            ReduceTuple hv = reduce_data.value(reduce_op);
+            const int family_min = amrex::get<0>(hv);
+            const int nfamily = amrex::get<1>(hv) - family_min + 1;
+            const int nnborhood = amrex::max(amrex::get<2>(hv) + 1, 1);
 
-            auto& soa = ptile.GetStructOfArrays();
-            auto home_i_ptr = soa.GetIntData(IntIdx::home_i).data();
-            auto home_j_ptr = soa.GetIntData(IntIdx::home_j).data();
+            const Box box = mfi.validbox();
+            const auto ncells = static_cast<int>(box.numPts());
 
-            amrex::ParallelFor( np,
-            [=] AMREX_GPU_DEVICE (int ip) noexcept
+            Gpu::DeviceVector<unsigned int> agent_idx(np);
+            auto agent_idx_ptr = agent_idx.data();
+            ParallelFor( np, [=] AMREX_GPU_DEVICE (int i) noexcept
+            {
+                agent_idx_ptr[i] = i;
+            });
+            Gpu::synchronize();
+
+            /* first pass: by family */
+            DenseBins<unsigned int> family_bins;
+            family_bins.build(BinPolicy::Serial, np, agent_idx_ptr, nfamily,
+                              [=] AMREX_GPU_HOST_DEVICE (unsigned int i) noexcept -> unsigned int
+                              {
+                                  return static_cast<unsigned int>(family_ptr[i] - family_min);
+                              });
+            auto family_perm = family_bins.permutationPtr();
+            ParallelFor( np, [=] AMREX_GPU_DEVICE (int k) noexcept
+            {
+                agent_idx_ptr[k] = family_perm[k];
+            });
+            Gpu::synchronize();
+
+            /* second pass: by home community and neighborhood, keeping the family order */
+            DenseBins<unsigned int> home_bins;
+            home_bins.build(BinPolicy::Serial, np, agent_idx_ptr, ncells*nnborhood,
+                            [=] AMREX_GPU_HOST_DEVICE (unsigned int i) noexcept -> unsigned int
+                            {
+                                return static_cast<unsigned int>(
+                                    locationBin(static_cast<int>(i), ptd, box, false)*nnborhood
+                                    + nborhood_ptr[i]);
+                            });
+            auto home_perm = home_bins.permutationPtr();
+
+            Gpu::DeviceVector<unsigned int> perm(np);
+            auto perm_ptr = perm.data();
+            ParallelFor( np, [=] AMREX_GPU_DEVICE (int k) noexcept
             {
-                ParticleType& p = pstruct[ip];
-                p.pos(0) = (home_i_ptr[ip] + 0.5_prt)*dx[0];
-                p.pos(1) = (home_j_ptr[ip] + 0.5_prt)*dx[1];
+                perm_ptr[k] = agent_idx_ptr[home_perm[k]];
             });
+            Gpu::synchronize();
+
+            ReorderParticles(lev, mfi, perm_ptr);
+
+            /* scheduled disease transitions refer to agent indices */
+            auto calendars = m_disease_calendars.find(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+            if (calendars != m_disease_calendars.end()) {
+                Gpu::DeviceVector<int> new_index(np);
+                auto new_index_ptr = new_index.data();
+                ParallelFor( np, [=] AMREX_GPU_DEVICE (int k) noexcept
+                {
+                    new_index_ptr[perm_ptr[k]] = k;
+                });
+                Gpu::synchronize();
+                for (auto& calendar : calendars->second) {
+                    calendar.remap(new_index_ptr);
+                }
+            }
         }
     }
 
-    m_at_work = false;
+    m_bins_home.clear();
+    m_bins_work.clear();
+    m_group_bins_home.clear();
+    m_group_bins_work.clear();
+    m_group_bins_school.clear();
+    m_infectious_home.clear();
+    m_infectious_work.clear();
+    m_infectious_school.clear();
+    m_infectious_nborhood_home.clear();
+    m_infectious_nborhood_work.clear();
 }
 
 /*! \brief Move agents randomly
@@ -823,11 +1184,23 @@ void AgentContainer::moveRandomTravel ()
         age-group-wise probabilities to move agent to ICU and then to ventilator. Adjust timer
         accordingly.
       + Update the community-wise disease stats tracker MultiFab according to hospitalization/ICU/vent
-        status (using the agent's home community)
+        status (using the agent's home community); the changes of the agents of a tile are
+        recorded per agent and added up by home community afterwards (see addDiseaseStats()),
+        without atomic updates
       + Else (beyond 3 days), count down hospital timer if agent is hospitalized. At end of hospital
         stay, determine if agent is #Status dead or #Status::immune. For non-hospitalized agents,
         set them to #Status::immune after incubation length + infection length days.
 
+    With the event calendar (agent.event_calendar), only the agents with a transition on this
+    day are visited (see #DiseaseCalendar and nextDiseaseEvent()): their disease clock and
+    hospital timer are first advanced to the previous day, the same daily progression is
+    applied, and their next transition is scheduled. On the other days, the disease clock of
+    infected and immune agents is not updated; it only needs to be up to date on the day the
+    agents become infectious (see isInfectious()), which is a transition.
+
+    The changes of #PopulationCategory of the visited agents are added to the incremental
+    counts of the daily summary (see AgentContainer::getDailySummary()).
+
     The input argument is a MultiFab with 4 components corresponding to "hospitalizations", "ICU",
     "ventilator", and "death". It contains the cumulative totals of these quantities for each
     community as the simulation progresses.
@@ -836,9 +1209,14 @@ void AgentContainer::updateStatus (MFPtrVec& a_disease_stats /*!< Community-wise
 {
     BL_PROFILE("AgentContainer::updateStatus");
 
+    /* infectious status may change; see InteractionModel::makeInfectiousLists() */
+    m_status_version++;
+    PopulationTally tally(m_num_diseases);
+
     for (int lev = 0; lev <= finestLevel(); ++lev)
     {
         auto& plev  = GetParticles(lev);
+        if (m_event_calendar) { prepareDiseaseCalendars(lev); }
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -850,207 +1228,332 @@ void AgentContainer::updateStatus (MFPtrVec& a_disease_stats /*!< Community-wise
             auto& ptile = plev[std::make_pair(gid, tid)];
             auto& soa   = ptile.GetStructOfArrays();
             const auto np = ptile.numParticles();
+            auto pstruct = ptile.GetArrayOfStructs()().data();
 
-            auto age_group_ptr = soa.GetIntData(IntIdx::age_group).data();
+            auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
             auto home_i_ptr = soa.GetIntData(IntIdx::home_i).data();
             auto home_j_ptr = soa.GetIntData(IntIdx::home_j).data();
-            auto withdrawn_ptr = soa.GetIntData(IntIdx::withdrawn).data();
-            auto timer_ptr = soa.GetRealData(RealIdx::treatment_timer).data();
 
             int i_RT = IntIdx::nattribs;
             int r_RT = RealIdx::nattribs;
             int n_disease = m_num_diseases;
+            const bool counter_rng = m_counter_rng;
+            const int day = m_day;
 
             for (int d = 0; d < n_disease; d++) {
 
-                auto status_ptr      = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::status).data();
-                auto symptomatic_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::symptomatic).data();
-
-                auto counter_ptr           = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::disease_counter).data();
-                auto prob_ptr              = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
-                auto incubation_period_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::incubation_period).data();
-                auto infectious_period_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::infectious_period).data();
-                auto symptomdev_period_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::symptomdev_period).data();
-
-                auto* lparm = d_parm[d];
-                auto ds_arr = (*a_disease_stats[d])[mfi].array();
-
-                struct DiseaseStats
-                {
-                    enum {
-                        hospitalization = 0,
-                        ICU,
-                        ventilator,
-                        death
-                    };
-                };
-
-                auto symptomatic_withdraw = m_symptomatic_withdraw;
-                auto symptomatic_withdraw_compliance = m_symptomatic_withdraw_compliance;
-
-                auto mean_immune_time = h_parm[d]->mean_immune_time;
-                auto immune_time_spread = h_parm[d]->immune_time_spread;
-
-                // Track hospitalization, ICU, ventilator, and fatalities
-                Real CHR[] = {.0104_rt, .0104_rt, .070_rt, .28_rt, 1.0_rt};  // sick -> hospital probabilities
-                Real CIC[] = {.24_rt, .24_rt, .24_rt, .36_rt, .35_rt};      // hospital -> ICU probabilities
-                Real CVE[] = {.12_rt, .12_rt, .12_rt, .22_rt, .22_rt};      // ICU -> ventilator probabilities
-                Real CVF[] = {.20_rt, .20_rt, .20_rt, 0.45_rt, 1.26_rt};    // ventilator -> dead probilities
-                amrex::ParallelForRNG( np,
-                                       [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
-                {
-                    prob_ptr[i] = 1.0_rt;
-                    if ( status_ptr[i] == Status::never ||
-                         status_ptr[i] == Status::susceptible ) {
-                        return;
+                auto state_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+                auto clock_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+                auto schedule_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+
+                auto prob_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
+
+                DiseaseProgression progress{ traits_ptr, state_ptr, clock_ptr, schedule_ptr,
+                                             d_parm[d],
+                                             m_symptomatic_withdraw,
+                                             m_symptomatic_withdraw_compliance,
+                                             h_parm[d]->mean_immune_time,
+                                             h_parm[d]->immune_time_spread,
+                                             h_parm[d]->nearest_day_rounding };
+                const Box ds_box = mfi.tilebox();
+                const auto ds_arr = (*a_disease_stats[d])[mfi].array();
+
+                if (m_event_calendar) {
+                    auto& calendar = m_disease_calendars[std::make_pair(gid, tid)][d];
+                    if (!calendar.initialized) {
+                        scheduleNewDiseaseEvents(calendar, static_cast<int>(np), state_ptr, clock_ptr,
+                                                 schedule_ptr, traits_ptr, day);
                     }
-                    else if (status_ptr[i] == Status::immune) {
-                        counter_ptr[i] -= 1.0_rt;
-                        if (counter_ptr[i] < 0.0_rt) {
-                            counter_ptr[i] = 0.0_rt;
-                            timer_ptr[i] = 0.0_rt;
-                            status_ptr[i] = Status::susceptible;
-                            return;
-                        }
-                    }
-                    else if (status_ptr[i] == Status::infected) {
-                        counter_ptr[i] += 1;
-                        if (counter_ptr[i] == 1) {
-                            if (amrex::Random(engine) < lparm->p_asymp[0]) {
-                                symptomatic_ptr[i] = SymptomStatus::asymptomatic;
-                            } else {
-                                symptomatic_ptr[i] = SymptomStatus::presymptomatic;
-                            }
-                        }
-                        if (counter_ptr[i] == amrex::Math::floor(symptomdev_period_ptr[i])) {
-                            if (symptomatic_ptr[i] != SymptomStatus::asymptomatic) {
-                                symptomatic_ptr[i] = SymptomStatus::symptomatic;
-                            }
-                            if (    (symptomatic_ptr[i] == SymptomStatus::symptomatic)
-                                &&  (symptomatic_withdraw)
-                                &&  (amrex::Random(engine) < symptomatic_withdraw_compliance)) {
-                                withdrawn_ptr[i] = 1;
+
+                    auto events = calendar.pop(day);
+                    const auto nevents = static_cast<int>(events.size());
+                    Gpu::DeviceVector<DiseaseEvent> next_events(nevents);
+                    Gpu::DeviceVector<int> next_days(nevents);
+                    Gpu::DeviceVector<int> stats_events(nevents);
+                    Gpu::DeviceVector<int> transitions(nevents);
+                    auto events_ptr = events.data();
+                    auto next_events_ptr = next_events.data();
+                    auto next_days_ptr = next_days.data();
+                    auto stats_events_ptr = stats_events.data();
+                    auto transitions_ptr = transitions.data();
+
+                    amrex::ParallelForRNG( nevents,
+                                           [=] AMREX_GPU_DEVICE (int k, amrex::RandomEngine const& engine) noexcept
+                    {
+                        const DiseaseEvent event = events_ptr[k];
+                        const int i = event.idx;
+                        next_days_ptr[k] = -1;
+                        stats_events_ptr[k] = StatsEvent::none;
+                        transitions_ptr[k] = PopulationCategory::none;
+                        const int category = PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]);
+
+                        const int status = DiseaseState::status::get(state_ptr[i]);
+                        const int counter = DiseaseClock::counter::get(clock_ptr[i]);
+                        if ((status == Status::infected) && (event.counter > counter)) {
+                            /* count down the hospital days since the last transition */
+                            const int timer = AgentTraits::treatment_timer::get(traits_ptr[i]);
+                            if (    (timer > 0)
+                                 && (counter >= DiseaseSchedule::infectious_day::get(schedule_ptr[i])) ) {
+                                AgentTraits::treatment_timer::set(traits_ptr[i],
+                                    amrex::max(timer - (event.counter - 1 - counter), 0));
                             }
-                        }
-                        if (counter_ptr[i] < incubation_period_ptr[i]) {
-                            // incubation phase
+                            DiseaseClock::counter::set(clock_ptr[i], event.counter - 1);
+                        } else if ((status == Status::immune) && (event.counter < 0)) {
+                            DiseaseClock::counter::set(clock_ptr[i], 0);
+                        } else {
                             return;
                         }
-                        if (counter_ptr[i] == amrex::Math::ceil(incubation_period_ptr[i])) {
-                            // decide if hospitalized
-                            Real p_hosp = CHR[age_group_ptr[i]];
-                            if (amrex::Random(engine) < p_hosp) {
-                                if ((age_group_ptr[i]) < 3) {  // age groups 0-4, 5-18, 19-29
-                                    timer_ptr[i] = 3;  // Ages 0-49 hospitalized for 3.1 days
-                                }
-                                else if (age_group_ptr[i] == 4) {
-                                    timer_ptr[i] = 7;  // Age 65+ hospitalized for 6.5 days
-                                }
-                                else if (amrex::Random(engine) < 0.57) {
-                                    timer_ptr[i] = 3;  // Proportion of 30-64 that is under 50
-                                }
-                                else {
-                                    timer_ptr[i] = 8;  // Age 50-64 hospitalized for 7.8 days
-                                }
-                                amrex::Gpu::Atomic::AddNoRet(
-                                    &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                            DiseaseStats::hospitalization), 1.0_rt);
-                                if (amrex::Random(engine) < CIC[age_group_ptr[i]]) {
-                                    //std::printf("putting h in icu \n");
-                                    timer_ptr[i] += 10;  // move to ICU
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                        &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                DiseaseStats::ICU), 1.0_rt);
-                                    if (amrex::Random(engine) < CVE[age_group_ptr[i]]) {
-                                        //std::printf("putting icu on v \n");
-                                        amrex::Gpu::Atomic::AddNoRet(
-                                        &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                DiseaseStats::ventilator), 1.0_rt);
-                                        timer_ptr[i] += 10;  // put on ventilator
-                                    }
-                                }
-                            }
+
+                        AgentRNG rng = counter_rng ? AgentRNG(agentKey(pstruct[i]), day, RNGStream::progression, d)
+                                                   : AgentRNG(engine);
+                        stats_events_ptr[k] = progress(i, rng);
+                        transitions_ptr[k] = PopulationCategory::transition(category,
+                            PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]));
+
+                        int next_counter;
+                        const int delay = nextDiseaseEvent( state_ptr[i], clock_ptr[i], schedule_ptr[i],
+                                                            traits_ptr[i], next_counter );
+                        if (delay > 0) {
+                            next_events_ptr[k] = DiseaseEvent{i, next_counter};
+                            next_days_ptr[k] = day + delay;
                         } else {
-                            if (timer_ptr[i] > 0.0_rt) {
-                                // do hospital things
-                                timer_ptr[i] -= 1.0_rt;
-                                if (timer_ptr[i] == 0) {
-                                    if (CVF[age_group_ptr[i]] > 2.0_rt) {
-                                        if (amrex::Random(engine) < (CVF[age_group_ptr[i]] - 2.0_rt)) {
-                                            amrex::Gpu::Atomic::AddNoRet(
-                                                &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                        DiseaseStats::death), 1.0_rt);
-                                            status_ptr[i] = Status::dead;
-                                        }
-                                    }
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                                                 &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                                         DiseaseStats::hospitalization), -1.0_rt);
-                                    if (status_ptr[i] != Status::dead) {
-                                        status_ptr[i] = Status::immune;  // If alive, hospitalized patient recovers
-                                        counter_ptr[i] = (mean_immune_time - immune_time_spread) + 2.0_rt*immune_time_spread*amrex::Random(engine);
-                                        symptomatic_ptr[i] = SymptomStatus::presymptomatic;
-                                        withdrawn_ptr[i] = 0;
-                                    }
-                                }
-                                if (timer_ptr[i] == 10) {
-                                    if (CVF[age_group_ptr[i]] > 1.0_rt) {
-                                        if (amrex::Random(engine) < (CVF[age_group_ptr[i]] - 1.0_rt)) {
-                                            amrex::Gpu::Atomic::AddNoRet(
-                                                &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                        DiseaseStats::death), 1.0_rt);
-                                            status_ptr[i] = Status::dead;
-                                        }
-                                    }
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                                                 &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                                         DiseaseStats::hospitalization), -1.0_rt);
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                                                 &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                                         DiseaseStats::ICU), -1.0_rt);
-                                    if (status_ptr[i] != Status::dead) {
-                                        status_ptr[i] = Status::immune;  // If alive, ICU patient recovers
-                                        counter_ptr[i] = (mean_immune_time - immune_time_spread) + 2.0_rt*immune_time_spread*amrex::Random(engine);
-                                        symptomatic_ptr[i] = SymptomStatus::presymptomatic;
-                                        withdrawn_ptr[i] = 0;
-                                    }
-                                }
-                                if (timer_ptr[i] == 20) {
-                                    if (amrex::Random(engine) < CVF[age_group_ptr[i]]) {
-                                        amrex::Gpu::Atomic::AddNoRet(
-                                            &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                    DiseaseStats::death), 1.0_rt);
-                                        status_ptr[i] = Status::dead;
-                                    }
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                                                 &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                                         DiseaseStats::hospitalization), -1.0_rt);
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                                                 &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                                         DiseaseStats::ICU), -1.0_rt);
-                                    amrex::Gpu::Atomic::AddNoRet(
-                                                                 &ds_arr(home_i_ptr[i], home_j_ptr[i], 0,
-                                                                         DiseaseStats::ventilator), -1.0_rt);
-                                    if (status_ptr[i] != Status::dead) {
-                                        status_ptr[i] = Status::immune;  // If alive, ventilated patient recovers
-                                    counter_ptr[i] = (mean_immune_time - immune_time_spread) + 2.0_rt*immune_time_spread*amrex::Random(engine);
-                                    symptomatic_ptr[i] = SymptomStatus::presymptomatic;
-                                    withdrawn_ptr[i] = 0;
-                                    }
-                                }
-                            }
-                            else { // not hospitalized, recover once not infectious
-                                if (counter_ptr[i] >= (incubation_period_ptr[i] + infectious_period_ptr[i])) {
-                                    status_ptr[i] = Status::immune;
-                                    counter_ptr[i] = (mean_immune_time - immune_time_spread) + 2.0_rt*immune_time_spread*amrex::Random(engine);
-                                    symptomatic_ptr[i] = SymptomStatus::presymptomatic;
-                                    withdrawn_ptr[i] = 0;
-                                }
-                            }
+                            DiseaseState::scheduled::set(state_ptr[i], 0);
+                        }
+                    });
+                    Gpu::synchronize();
+
+                    addDiseaseStats( nevents, stats_events_ptr,
+                                     [=] AMREX_GPU_HOST_DEVICE (int k) noexcept { return events_ptr[k].idx; },
+                                     home_i_ptr, home_j_ptr, ds_box, ds_arr );
+                    tally.add(d, nevents, transitions_ptr);
+                    calendar.schedule(next_events_ptr, next_days_ptr, nevents);
+                } else {
+                    Gpu::DeviceVector<int> stats_events(np);
+                    Gpu::DeviceVector<int> transitions(np);
+                    auto stats_events_ptr = stats_events.data();
+                    auto transitions_ptr = transitions.data();
+                    amrex::ParallelForRNG( np,
+                                           [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
+                    {
+                        prob_ptr[i] = 1.0_rt;
+                        stats_events_ptr[i] = StatsEvent::none;
+                        transitions_ptr[i] = PopulationCategory::none;
+                        if (    (DiseaseState::status::get(state_ptr[i]) == Status::infected)
+                             || (DiseaseState::status::get(state_ptr[i]) == Status::immune) ) {
+                            const int category = PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]);
+                            AgentRNG rng = counter_rng ? AgentRNG(agentKey(pstruct[i]), day, RNGStream::progression, d)
+                                                       : AgentRNG(engine);
+                            stats_events_ptr[i] = progress(i, rng);
+                            transitions_ptr[i] = PopulationCategory::transition(category,
+                                PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]));
+                        }
+                    });
+                    Gpu::synchronize();
+
+                    addDiseaseStats( static_cast<int>(np), stats_events_ptr,
+                                     [=] AMREX_GPU_HOST_DEVICE (int k) noexcept { return k; },
+                                     home_i_ptr, home_j_ptr, ds_box, ds_arr );
+                    tally.add(d, static_cast<int>(np), transitions_ptr);
+                }
+            }
+        }
+    }
+
+    addPopulationChanges(tally);
+    m_day++;
+}
+
+/*! \brief Create the (empty) event calendars of the tiles at a level that do not have one
+    yet (see #DiseaseCalendar); must be called before the tile loops, so that the map of
+    calendars is not modified within the loops */
+void AgentContainer::prepareDiseaseCalendars (const int a_lev /*!< level */)
+{
+    for (MFIter mfi = MakeMFIter(a_lev, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        auto& calendars = m_disease_calendars[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        if (static_cast<int>(calendars.size()) < m_num_diseases) {
+            calendars.resize(m_num_diseases);
+        }
+    }
+}
+
+/*! \brief Schedule the next transition of the agents of a tile that are infected or immune
+    for a disease but have no transition in its event calendar yet
+
+    These are the agents infected (or immune) at initialization, when the calendar is first
+    used, and the newly infected agents (see AgentContainer::infectAgents()). The agents are
+    marked (#DiseaseState::scheduled) until their disease has no more transitions.
+*/
+void AgentContainer::scheduleNewDiseaseEvents ( DiseaseCalendar&  a_calendar, /*!< event calendar */
+                                                const int         a_np, /*!< number of agents */
+                                                int* const        a_state_ptr, /*!< disease state of agents */
+                                                const int* const  a_clock_ptr, /*!< disease clock of agents */
+                                                const int* const  a_schedule_ptr, /*!< disease transition days of agents */
+                                                const int* const  a_traits_ptr, /*!< traits of agents */
+                                                const int         a_day /*!< index of the next status update */ )
+{
+    BL_PROFILE("AgentContainer::scheduleNewDiseaseEvents");
+
+    Gpu::DeviceVector<DiseaseEvent> events(a_np);
+    Gpu::DeviceVector<int> days(a_np);
+    auto events_ptr = events.data();
+    auto days_ptr = days.data();
+
+    auto is_new = [=] AMREX_GPU_DEVICE (int i) -> bool
+    {
+        const int status = DiseaseState::status::get(a_state_ptr[i]);
+        return (    ((status == Status::infected) || (status == Status::immune))
+                 && !DiseaseState::scheduled::get(a_state_ptr[i]) );
+    };
+
+    const int nnew = Scan::PrefixSum<int>(a_np,
+                        [=] AMREX_GPU_DEVICE (int i) -> int {
+                            return is_new(i) ? 1 : 0;
+                        },
+                        [=] AMREX_GPU_DEVICE (int i, int const& x) {
+                            if (!is_new(i)) { return; }
+                            int counter;
+                            const int delay = nextDiseaseEvent( a_state_ptr[i], a_clock_ptr[i], a_schedule_ptr[i],
+                                                                a_traits_ptr[i], counter );
+                            events_ptr[x] = DiseaseEvent{i, counter};
+                            days_ptr[x] = a_day + delay - 1;
+                            DiseaseState::scheduled::set(a_state_ptr[i], 1);
+                        },
+                        Scan::Type::exclusive, Scan::retSum);
+
+    a_calendar.schedule(events_ptr, days_ptr, nnew);
+    a_calendar.initialized = true;
+}
+
+/*! \brief Bring the disease clocks of the agents up to date with their event calendars, and
+    empty the calendars
+
+    With the event calendar (agent.event_calendar), the disease clock (and hospital timer) of an
+    agent is only advanced on the days it has a transition; this sets them to the values they
+    would have with the daily sweep before the next status update, and unmarks the agents
+    (#DiseaseState::scheduled), so that the calendars are rebuilt from the agent data alone on
+    the next status update (see AgentContainer::scheduleNewDiseaseEvents()), with the same
+    transition days. Used before writing a checkpoint, since the calendars refer to agent
+    indices that change on restart.
+*/
+void AgentContainer::flushDiseaseCalendars ()
+{
+    BL_PROFILE("AgentContainer::flushDiseaseCalendars");
+    if (m_disease_calendars.empty()) { return; }
+
+    const int lev = 0;
+    const int i_RT = IntIdx::nattribs;
+    const int day = m_day;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        auto calendars = m_disease_calendars.find(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+        if (calendars == m_disease_calendars.end()) { continue; }
+        auto& ptile = ParticlesAt(lev, mfi);
+        auto& soa = ptile.GetStructOfArrays();
+        const auto np = static_cast<int>(ptile.numParticles());
+        auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
+
+        for (int d = 0; d < static_cast<int>(calendars->second.size()); d++) {
+            auto state_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+            auto clock_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+            auto schedule_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+
+            for (auto& bucket : calendars->second[d].buckets) {
+                const int due = bucket.first;
+                auto events_ptr = bucket.second.data();
+                ParallelFor( static_cast<int>(bucket.second.size()), [=] AMREX_GPU_DEVICE (int k) noexcept
+                {
+                    const DiseaseEvent event = events_ptr[k];
+                    const int i = event.idx;
+                    const int status = DiseaseState::status::get(state_ptr[i]);
+                    const int counter = DiseaseClock::counter::get(clock_ptr[i]);
+                    if ((status == Status::infected) && (event.counter > counter)) {
+                        /* clock before the status update of day, the transition being on day due */
+                        const int now = event.counter - 1 - (due - day);
+                        const int timer = AgentTraits::treatment_timer::get(traits_ptr[i]);
+                        if (    (timer > 0)
+                             && (counter >= DiseaseSchedule::infectious_day::get(schedule_ptr[i])) ) {
+                            AgentTraits::treatment_timer::set(traits_ptr[i], amrex::max(timer - (now - counter), 0));
                         }
+                        DiseaseClock::counter::set(clock_ptr[i], now);
+                    } else if ((status == Status::immune) && (event.counter < 0)) {
+                        DiseaseClock::counter::set(clock_ptr[i], due - day);
                     }
                 });
             }
+            ParallelFor( np, [=] AMREX_GPU_DEVICE (int i) noexcept
+            {
+                DiseaseState::scheduled::set(state_ptr[i], 0);
+            });
+            Gpu::synchronize();
+        }
+    }
+
+    m_disease_calendars.clear();
+}
+
+/*! \brief Write the agents to a checkpoint
+
+    Writes all the components (AoS and SoA) of the agents to [a_dir]/agents, with the
+    parallel particle I/O of AMReX (see amrex::ParticleContainer::Checkpoint()); the event
+    calendars are flushed first (see AgentContainer::flushDiseaseCalendars()). The other state
+    of the container needed to restart (the number of status updates performed) is returned
+    by AgentContainer::day() and written by ExaEpi::IO::writeCheckpoint().
+*/
+void AgentContainer::checkpoint (const std::string& a_dir /*!< checkpoint directory */)
+{
+    BL_PROFILE("AgentContainer::checkpoint");
+    flushDiseaseCalendars();
+    Checkpoint(a_dir, "agents");
+}
+
+/*! \brief Read the agents from a checkpoint written by AgentContainer::checkpoint()
+
+    The agents are redistributed to the boxes of this container, so the number of processors
+    may differ from that of the run that wrote the checkpoint. The cached bins, lists, and
+    calendars of the agents, and the incremental counts, are reset. With the event calendar,
+    the infection probabilities are reset too, since the status update does not reset them
+    (the checkpoint may have been written without the calendar).
+*/
+void AgentContainer::restart (const std::string& a_dir, /*!< checkpoint directory */
+                              const int a_day /*!< number of status updates performed */)
+{
+    BL_PROFILE("AgentContainer::restart");
+    Restart(a_dir, "agents");
+
+    m_day = a_day;
+    m_status_version++;
+    m_population_counts_valid = false;
+    m_disease_calendars.clear();
+    m_contact_groups.clear();
+    m_bins_home.clear();
+    m_bins_work.clear();
+    m_group_bins_home.clear();
+    m_group_bins_work.clear();
+    m_group_bins_school.clear();
+    m_infectious_home.clear();
+    m_infectious_work.clear();
+    m_infectious_school.clear();
+    m_infectious_nborhood_home.clear();
+    m_infectious_nborhood_work.clear();
+
+    if (m_event_calendar) {
+        for (int lev = 0; lev <= finestLevel(); ++lev) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+                auto& ptile = ParticlesAt(lev, mfi);
+                auto& soa = ptile.GetStructOfArrays();
+                const auto np = static_cast<int>(ptile.numParticles());
+                for (int d = 0; d < m_num_diseases; d++) {
+                    auto prob_ptr = soa.GetRealData(RealIdx::nattribs+r0(d)+RealIdxDisease::prob).data();
+                    ParallelFor( np, [=] AMREX_GPU_DEVICE (int i) noexcept { prob_ptr[i] = 1.0_prt; });
+                }
+            }
         }
     }
 }
@@ -1076,14 +1579,19 @@ void AgentContainer::shelterStart ()
             auto& ptile = plev[std::make_pair(gid, tid)];
             auto& soa   = ptile.GetStructOfArrays();
             const auto np = ptile.numParticles();
-            auto withdrawn_ptr = soa.GetIntData(IntIdx::withdrawn).data();
+            auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
+            auto pstruct = ptile.GetArrayOfStructs()().data();
 
             auto shelter_compliance = m_shelter_compliance;
+            const bool counter_rng = m_counter_rng;
+            const int day = m_day;
             amrex::ParallelForRNG( np,
             [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
             {
-                if (amrex::Random(engine) < shelter_compliance) {
-                    withdrawn_ptr[i] = 1;
+                AgentRNG rng = counter_rng ? AgentRNG(agentKey(pstruct[i]), day, RNGStream::shelter, 0)
+                                           : AgentRNG(engine);
+                if (rng.random() < shelter_compliance) {
+                    AgentTraits::withdrawn::set(traits_ptr[i], 1);
                 }
             });
         }
@@ -1111,11 +1619,11 @@ void AgentContainer::shelterStop ()
             auto& ptile = plev[std::make_pair(gid, tid)];
             auto& soa   = ptile.GetStructOfArrays();
             const auto np = ptile.numParticles();
-            auto withdrawn_ptr = soa.GetIntData(IntIdx::withdrawn).data();
+            auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
 
             amrex::ParallelFor( np, [=] AMREX_GPU_DEVICE (int i) noexcept
             {
-                withdrawn_ptr[i] = 0;
+                AgentTraits::withdrawn::set(traits_ptr[i], 0);
             });
         }
     }
@@ -1123,14 +1631,25 @@ void AgentContainer::shelterStop ()
 
 /*! \brief Infect agents based on their current status and the computed probability of infection.
     The infection probability is computed in AgentContainer::interactAgentsHomeWork() or
-    AgentContainer::interactAgents() */
+    AgentContainer::interactAgents()
+
+    With the event calendar (agent.event_calendar), the infection probabilities are reset here
+    (instead of in AgentContainer::updateStatus()), and the first transition of the newly
+    infected agents is scheduled (see AgentContainer::scheduleNewDiseaseEvents()). The newly
+    infected agents are added to the incremental counts of the daily summary (see
+    AgentContainer::getDailySummary()). */
 void AgentContainer::infectAgents ()
 {
     BL_PROFILE("AgentContainer::infectAgents");
 
+    /* infectious status may change; see InteractionModel::makeInfectiousLists() */
+    m_status_version++;
+    PopulationTally tally(m_num_diseases);
+
     for (int lev = 0; lev <= finestLevel(); ++lev)
     {
         auto& plev  = GetParticles(lev);
+        if (m_event_calendar) { prepareDiseaseCalendars(lev); }
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -1142,42 +1661,156 @@ void AgentContainer::infectAgents ()
             auto& ptile = plev[std::make_pair(gid, tid)];
             auto& soa   = ptile.GetStructOfArrays();
             const auto np = ptile.numParticles();
+            auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
+            auto pstruct = ptile.GetArrayOfStructs()().data();
 
             int i_RT = IntIdx::nattribs;
             int r_RT = RealIdx::nattribs;
             int n_disease = m_num_diseases;
+            const bool reset_prob = m_event_calendar;
+            const bool counter_rng = m_counter_rng;
+            const int day = m_day;
 
             for (int d = 0; d < n_disease; d++) {
 
-                auto status_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::status).data();
+                auto state_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+                auto clock_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+                auto schedule_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
 
-                auto counter_ptr           = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::disease_counter).data();
-                auto prob_ptr              = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
-                auto incubation_period_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::incubation_period).data();
-                auto infectious_period_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::infectious_period).data();
-                auto symptomdev_period_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::symptomdev_period).data();
+                auto prob_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
 
-                auto* lparm = d_parm[d];
+                DiseaseInfection infect{ state_ptr, clock_ptr, schedule_ptr, d_parm[d] };
 
+                Gpu::DeviceVector<int> transitions(np);
+                auto transitions_ptr = transitions.data();
                 amrex::ParallelForRNG( np,
                 [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
                 {
-                    prob_ptr[i] = 1.0_rt - prob_ptr[i];
-                    if ( status_ptr[i] == Status::never ||
-                         status_ptr[i] == Status::susceptible ) {
-                        if (amrex::Random(engine) < prob_ptr[i]) {
-                            status_ptr[i] = Status::infected;
-                            counter_ptr[i] = 0.0_rt;
-                            incubation_period_ptr[i] = amrex::RandomNormal(lparm->incubation_length_mean, lparm->incubation_length_std, engine);
-                            infectious_period_ptr[i] = amrex::RandomNormal(lparm->infectious_length_mean, lparm->infectious_length_std, engine);
-                            symptomdev_period_ptr[i] = amrex::RandomNormal(lparm->symptomdev_length_mean, lparm->symptomdev_length_std, engine);
-                            return;
-                        }
+                    const ParticleReal p_infect = 1.0_prt - prob_ptr[i];
+                    prob_ptr[i] = reset_prob ? 1.0_prt : p_infect;
+                    const int category = PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]);
+                    AgentRNG rng = counter_rng ? AgentRNG(agentKey(pstruct[i]), day, RNGStream::infection, d)
+                                               : AgentRNG(engine);
+                    transitions_ptr[i] = infect(i, p_infect, rng)
+                        ? PopulationCategory::transition(category,
+                              PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]))
+                        : PopulationCategory::none;
+                });
+                tally.add(d, static_cast<int>(np), transitions_ptr);
+
+                if (m_event_calendar) {
+                    scheduleNewDiseaseEvents(m_disease_calendars[std::make_pair(gid, tid)][d],
+                                             static_cast<int>(np), state_ptr, clock_ptr, schedule_ptr,
+                                             traits_ptr, m_day);
+                }
+            }
+        }
+    }
+
+    addPopulationChanges(tally);
+}
+
+/*! \brief Infect agents (see AgentContainer::infectAgents()) and update the disease status of
+    all agents for the next day (see AgentContainer::updateStatus()) in a single sweep
+
+    For each agent and disease: draw the infection from the infection probability, advance
+    the disease of infected and immune agents by one day (including the agents just infected),
+    and reset the infection probability; this is the same as AgentContainer::infectAgents()
+    followed by AgentContainer::updateStatus(), but each per-disease attribute of an agent is
+    read and written once. With the event calendar (agent.event_calendar), the two are
+    called one after the other, since only the agents with a transition are updated.
+*/
+void AgentContainer::infectAndUpdateStatus (MFPtrVec& a_disease_stats /*!< Community-wise disease stats tracker */)
+{
+    BL_PROFILE("AgentContainer::infectAndUpdateStatus");
+
+    if (m_event_calendar) {
+        infectAgents();
+        updateStatus(a_disease_stats);
+        return;
+    }
+
+    /* infectious status may change; see InteractionModel::makeInfectiousLists() */
+    m_status_version++;
+    PopulationTally tally(m_num_diseases);
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        auto& plev  = GetParticles(lev);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            auto& ptile = plev[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+            auto& soa   = ptile.GetStructOfArrays();
+            const auto np = ptile.numParticles();
+            auto pstruct = ptile.GetArrayOfStructs()().data();
+
+            auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
+            auto home_i_ptr = soa.GetIntData(IntIdx::home_i).data();
+            auto home_j_ptr = soa.GetIntData(IntIdx::home_j).data();
+
+            int i_RT = IntIdx::nattribs;
+            int r_RT = RealIdx::nattribs;
+            int n_disease = m_num_diseases;
+            const bool counter_rng = m_counter_rng;
+            const int day = m_day;
+
+            for (int d = 0; d < n_disease; d++) {
+
+                auto state_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+                auto clock_ptr    = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+                auto schedule_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+
+                auto prob_ptr = soa.GetRealData(r_RT+r0(d)+RealIdxDisease::prob).data();
+
+                DiseaseInfection infect{ state_ptr, clock_ptr, schedule_ptr, d_parm[d] };
+                DiseaseProgression progress{ traits_ptr, state_ptr, clock_ptr, schedule_ptr,
+                                             d_parm[d],
+                                             m_symptomatic_withdraw,
+                                             m_symptomatic_withdraw_compliance,
+                                             h_parm[d]->mean_immune_time,
+                                             h_parm[d]->immune_time_spread,
+                                             h_parm[d]->nearest_day_rounding };
+
+                Gpu::DeviceVector<int> stats_events(np);
+                Gpu::DeviceVector<int> transitions(np);
+                auto stats_events_ptr = stats_events.data();
+                auto transitions_ptr = transitions.data();
+                amrex::ParallelForRNG( np,
+                                       [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
+                {
+                    const ParticleReal p_infect = 1.0_prt - prob_ptr[i];
+                    prob_ptr[i] = 1.0_prt;
+                    const int category = PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]);
+                    AgentRNG infect_rng = counter_rng ? AgentRNG(agentKey(pstruct[i]), day, RNGStream::infection, d)
+                                                      : AgentRNG(engine);
+                    infect(i, p_infect, infect_rng);
+                    stats_events_ptr[i] = StatsEvent::none;
+                    if (    (DiseaseState::status::get(state_ptr[i]) == Status::infected)
+                         || (DiseaseState::status::get(state_ptr[i]) == Status::immune) ) {
+                        AgentRNG progress_rng = counter_rng ? AgentRNG(agentKey(pstruct[i]), day, RNGStream::progression, d)
+                                                            : AgentRNG(engine);
+                        stats_events_ptr[i] = progress(i, progress_rng);
                     }
+                    transitions_ptr[i] = PopulationCategory::transition(category,
+                        PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i]));
                 });
+                Gpu::synchronize();
+
+                addDiseaseStats( static_cast<int>(np), stats_events_ptr,
+                                 [=] AMREX_GPU_HOST_DEVICE (int k) noexcept { return k; },
+                                 home_i_ptr, home_j_ptr, mfi.tilebox(),
+                                 (*a_disease_stats[d])[mfi].array() );
+                tally.add(d, static_cast<int>(np), transitions_ptr);
             }
         }
     }
+
+    addPopulationChanges(tally);
+    m_day++;
 }
 
 /*! \brief Computes the number of agents with various #Status in each grid cell of the
@@ -1217,7 +1850,7 @@ void AgentContainer::generateCellData (MultiFab& mf /*!< MultiFab with at least
             auto iv = getParticleCell(p, plo, dxi, domain);
 
             for (int d = 0; d < n_disease; d++) {
-                int status = ptd.m_runtime_idata[i0(d)+IntIdxDisease::status][i];
+                int status = getDiseaseState<DiseaseState::status>(i, ptd, d);
                 Gpu::Atomic::AddNoRet(&count(iv, 5*d+0), 1.0_rt);
                 if (status != Status::dead) {
                     Gpu::Atomic::AddNoRet(&count(iv, 5*d+status+1), 1.0_rt);
@@ -1226,51 +1859,330 @@ void AgentContainer::generateCellData (MultiFab& mf /*!< MultiFab with at least
         }, false);
 }
 
-/*! \brief Computes the total number of agents with each #Status
+/*! \brief Computes the number of agents in each #PopulationCategory, for each disease, in
+    each unit (county/state) with communities on this processor
 
-    Returns a vector with 5 components corresponding to each value of #Status; each element is
-    the total number of agents at a step with the corresponding #Status (in that order).
+    The agents of each tile are sorted by the unit of the community they are in (given by
+    a_unit_mf), and each unit then counts its own agents, so that no atomic updates are
+    needed. a_local_unit maps a unit to its index in the local units (or -1 if it has no
+    community on this processor); on return, a_counts[(u*n + d)*#PopulationCategory::ncat + c]
+    is the number of agents in category c for disease d (n being the number of diseases) in
+    the local unit u.
 */
-std::array<Long, 9> AgentContainer::getTotals (const int a_d /*!< disease index */) {
-    BL_PROFILE("getTotals");
-    amrex::ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_ops;
-    auto r = amrex::ParticleReduce<ReduceData<int,int,int,int,int,int,int,int,int>> (
-                  *this, [=] AMREX_GPU_DEVICE (const AgentContainer::ParticleTileType::ConstParticleTileDataType& ptd, const int i) noexcept
-                  -> amrex::GpuTuple<int,int,int,int,int,int,int,int,int>
-              {
-                  int s[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-                  auto status = ptd.m_runtime_idata[i0(a_d)+IntIdxDisease::status][i];
-
-                  AMREX_ALWAYS_ASSERT(status >= 0);
-                  AMREX_ALWAYS_ASSERT(status <= 4);
-
-                  s[status] = 1;
-
-                  if (status == Status::infected) {  // exposed
-                      if (notInfectiousButInfected(i, ptd, a_d)) {
-                          s[5] = 1;  // exposed, but not infectious
-                      } else { // infectious
-                          if (ptd.m_runtime_idata[i0(a_d)+IntIdxDisease::symptomatic][i] == SymptomStatus::asymptomatic) {
-                              s[6] = 1;  // asymptomatic and will remain so
-                          }
-                          else if (ptd.m_runtime_idata[i0(a_d)+IntIdxDisease::symptomatic][i] == SymptomStatus::presymptomatic) {
-                              s[7] = 1;  // asymptomatic but will develop symptoms
-                          }
-                          else if (ptd.m_runtime_idata[i0(a_d)+IntIdxDisease::symptomatic][i] == SymptomStatus::symptomatic) {
-                              s[8] = 1;  // Infectious and symptomatic
-                          } else {
-                              amrex::Abort("how did I get here?");
-                          }
-                      }
-                  }
-                  return {s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8]};
-              }, reduce_ops);
-
-    std::array<Long, 9> counts = {amrex::get<0>(r), amrex::get<1>(r), amrex::get<2>(r), amrex::get<3>(r),
-                                  amrex::get<4>(r), amrex::get<5>(r), amrex::get<6>(r), amrex::get<7>(r),
-                                  amrex::get<8>(r)};
-    ParallelDescriptor::ReduceLongSum(&counts[0], 9, ParallelDescriptor::IOProcessorNumber());
-    return counts;
+void AgentContainer::generateUnitData (const iMultiFab& a_unit_mf, /*!< unit number of each community */
+                                       const int* a_local_unit, /*!< local index of each unit (device) */
+                                       const int a_nlocal, /*!< number of local units */
+                                       std::vector<Long>& a_counts /*!< agent counts of the local units */) const
+{
+    BL_PROFILE("AgentContainer::generateUnitData");
+
+    const int lev = 0;
+    const int n_disease = m_num_diseases;
+    const int i_RT = IntIdx::nattribs;
+    constexpr int ncat = PopulationCategory::ncat;
+    const int ncomp = n_disease*ncat;
+    a_counts.assign(static_cast<std::size_t>(a_nlocal)*ncomp, 0);
+    if (a_nlocal == 0) { return; }
+
+    const auto& geom = Geom(lev);
+    const auto plo = geom.ProbLoArray();
+    const auto dxi = geom.InvCellSizeArray();
+    const auto domain = geom.Domain();
+    const auto& plev = GetParticles(lev);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        auto it = plev.find(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+        if (it == plev.end()) { continue; }
+        const auto& ptile = it->second;
+        const auto np = static_cast<int>(ptile.numParticles());
+        if (np == 0) { continue; }
+
+        const auto& soa = ptile.GetStructOfArrays();
+        GpuArray<const int*,ExaEpi::max_num_diseases> state_ptrs, clock_ptrs, schedule_ptrs;
+        for (int d = 0; d < n_disease; d++) {
+            state_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+            clock_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+            schedule_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+        }
+        const auto unit_arr = a_unit_mf.const_array(mfi);
+
+        /* bin a_nlocal holds the agents outside of any unit */
+        DenseBins<ParticleType> bins;
+        bins.build(np, ptile.GetArrayOfStructs()().data(), a_nlocal+1,
+                   [=] AMREX_GPU_HOST_DEVICE (const ParticleType& p) noexcept -> unsigned int
+                   {
+                       const int unit = unit_arr(getParticleCell(p, plo, dxi, domain));
+                       const int u = (unit >= 0) ? a_local_unit[unit] : -1;
+                       return static_cast<unsigned int>((u >= 0) ? u : a_nlocal);
+                   });
+        auto perm = bins.permutationPtr();
+        auto offsets = bins.offsetsPtr();
+
+        Gpu::DeviceVector<Long> tile_counts(static_cast<std::size_t>(a_nlocal)*ncomp);
+        auto tile_counts_ptr = tile_counts.data();
+        ParallelFor( a_nlocal, [=] AMREX_GPU_DEVICE (int u) noexcept
+        {
+            for (int d = 0; d < n_disease; d++) {
+                Long c[PopulationCategory::ncat] = {0, 0, 0, 0, 0, 0, 0, 0};
+                for (auto p = offsets[u]; p < offsets[u+1]; ++p) {
+                    const auto i = perm[p];
+                    c[PopulationCategory::get(state_ptrs[d][i], clock_ptrs[d][i], schedule_ptrs[d][i])] += 1;
+                }
+                for (int k = 0; k < PopulationCategory::ncat; k++) {
+                    tile_counts_ptr[(u*n_disease + d)*PopulationCategory::ncat + k] = c[k];
+                }
+            }
+        });
+
+        std::vector<Long> h_tile_counts(tile_counts.size());
+        Gpu::copy(Gpu::deviceToHost, tile_counts.begin(), tile_counts.end(), h_tile_counts.begin());
+#ifdef AMREX_USE_OMP
+#pragma omp critical (generate_unit_data)
+#endif
+        for (std::size_t k = 0; k < h_tile_counts.size(); k++) {
+            a_counts[k] += h_tile_counts[k];
+        }
+    }
+}
+
+/*! \brief Computes the aggregation cube (see ExaEpi::IO::AggregationCube) of the agents on this
+    processor
+
+    The agents of each tile are sorted by their bin (the combination of the values of the
+    group-by keys, see ExaEpi::IO::CubeLayout::bin()), and each bin then counts its own agents in
+    each #PopulationCategory for each disease, so that no atomic updates are needed; on return,
+    a_cube[(b*n + d)*#PopulationCategory::ncat + c] is the number of agents in bin b and
+    category c for disease d (n being the number of diseases).
+*/
+void AgentContainer::generateCubeData (const iMultiFab& a_unit_mf, /*!< unit number of each community */
+                                       const ExaEpi::IO::CubeLayout& a_layout, /*!< group-by keys */
+                                       std::vector<Long>& a_cube /*!< agent counts of each bin */) const
+{
+    BL_PROFILE("AgentContainer::generateCubeData");
+
+    const int lev = 0;
+    const int n_disease = m_num_diseases;
+    const int i_RT = IntIdx::nattribs;
+    const int ncomp = n_disease*PopulationCategory::ncat;
+    const int nbins = a_layout.nbins;
+    a_cube.assign(static_cast<std::size_t>(nbins)*ncomp, 0);
+
+    const auto& geom = Geom(lev);
+    const auto plo = geom.ProbLoArray();
+    const auto dxi = geom.InvCellSizeArray();
+    const auto domain = geom.Domain();
+    const auto& plev = GetParticles(lev);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        auto it = plev.find(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+        if (it == plev.end()) { continue; }
+        const auto& ptile = it->second;
+        const auto np = static_cast<int>(ptile.numParticles());
+        if (np == 0) { continue; }
+
+        const auto pstruct = ptile.GetArrayOfStructs()().data();
+        const auto& soa = ptile.GetStructOfArrays();
+        const auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
+        GpuArray<const int*,ExaEpi::max_num_diseases> state_ptrs, clock_ptrs, schedule_ptrs;
+        for (int d = 0; d < n_disease; d++) {
+            state_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+            clock_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+            schedule_ptrs[d] = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+        }
+        const auto unit_arr = a_unit_mf.const_array(mfi);
+
+        Gpu::DeviceVector<int> items(np);
+        auto items_ptr = items.data();
+        ParallelFor( np, [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            items_ptr[i] = i;
+        });
+        Gpu::synchronize();
+
+        /* bin nbins holds the agents outside of any unit, if grouped by unit */
+        DenseBins<int> bins;
+        bins.build(np, items_ptr, nbins+1,
+                   [=] AMREX_GPU_HOST_DEVICE (int i) noexcept -> unsigned int
+                   {
+                       const int unit = unit_arr(getParticleCell(pstruct[i], plo, dxi, domain));
+                       const int b = a_layout.bin(unit, traits_ptr[i]);
+                       return static_cast<unsigned int>((b >= 0) ? b : nbins);
+                   });
+        auto perm = bins.permutationPtr();
+        auto offsets = bins.offsetsPtr();
+
+        Gpu::DeviceVector<Long> tile_cube(static_cast<std::size_t>(nbins)*ncomp);
+        auto tile_cube_ptr = tile_cube.data();
+        ParallelFor( nbins, [=] AMREX_GPU_DEVICE (int b) noexcept
+        {
+            for (int d = 0; d < n_disease; d++) {
+                Long c[PopulationCategory::ncat] = {0, 0, 0, 0, 0, 0, 0, 0};
+                for (auto p = offsets[b]; p < offsets[b+1]; ++p) {
+                    const auto i = perm[p];
+                    c[PopulationCategory::get(state_ptrs[d][i], clock_ptrs[d][i], schedule_ptrs[d][i])] += 1;
+                }
+                for (int k = 0; k < PopulationCategory::ncat; k++) {
+                    tile_cube_ptr[(static_cast<Long>(b)*n_disease + d)*PopulationCategory::ncat + k] = c[k];
+                }
+            }
+        });
+
+        std::vector<Long> h_tile_cube(tile_cube.size());
+        Gpu::copy(Gpu::deviceToHost, tile_cube.begin(), tile_cube.end(), h_tile_cube.begin());
+#ifdef AMREX_USE_OMP
+#pragma omp critical (generate_cube_data)
+#endif
+        for (std::size_t k = 0; k < h_tile_cube.size(); k++) {
+            a_cube[k] += h_tile_cube[k];
+        }
+    }
+}
+
+/*! \brief Computes the daily summary of all diseases (see #DailySummary)
+
+    The agent counts of all diseases (see #DailySummary) and the totals
+    of the community-wise disease stats are computed in a single pass over the tiles, with
+    64-bit integer sums (the disease stats hold whole numbers of agents), and a single MPI
+    reduction to the I/O processor for all diseases.
+
+    With agent.incremental_counts (the default), the agents are only counted the first time;
+    afterwards, the counts are maintained from the changes of #PopulationCategory recorded by
+    AgentContainer::updateStatus(), AgentContainer::infectAgents(), and
+    AgentContainer::infectAndUpdateStatus() (see AgentContainer::addPopulationChanges()), so
+    that only the disease stats are summed here. With agent.check_counts, the agents are also
+    counted, and the run aborts if the counts differ.
+*/
+std::vector<DailySummary> AgentContainer::getDailySummary (const MFPtrVec& a_disease_stats /*!< Community-wise disease stats tracker */)
+{
+    BL_PROFILE("AgentContainer::getDailySummary");
+    const int n_disease = m_num_diseases;
+    const int i_RT = IntIdx::nattribs;
+    constexpr int ncat = PopulationCategory::ncat;
+    const bool count_agents = !m_incremental_counts || !m_population_counts_valid || m_check_counts;
+
+    /* one reduction per disease: agents in each category, then 4 disease stats totals */
+    using ReduceOpsType = ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+                                    ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+                                    ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum>;
+    using ReduceDataType = ReduceData<Long, Long, Long, Long, Long, Long, Long, Long,
+                                      Long, Long, Long, Long>;
+    using ReduceTuple = typename ReduceDataType::Type;
+    ReduceOpsType reduce_ops;
+    std::vector<std::unique_ptr<ReduceDataType> > reduce_data(n_disease);
+    for (int d = 0; d < n_disease; d++) {
+        reduce_data[d] = std::make_unique<ReduceDataType>(reduce_ops);
+    }
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        auto& plev = GetParticles(lev);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi = MakeMFIter(lev, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            auto& ptile = plev[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+            auto& soa = ptile.GetStructOfArrays();
+            const auto np = static_cast<int>(ptile.numParticles());
+
+            for (int d = 0; d < n_disease; d++) {
+                if (count_agents) {
+                    const auto state_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::state).data();
+                    const auto clock_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::clock).data();
+                    const auto schedule_ptr = soa.GetIntData(i_RT+i0(d)+IntIdxDisease::schedule).data();
+
+                    reduce_ops.eval(np, *reduce_data[d],
+                    [=] AMREX_GPU_DEVICE (int i) noexcept -> ReduceTuple
+                    {
+                        Long s[PopulationCategory::ncat] = {0, 0, 0, 0, 0, 0, 0, 0};
+                        s[PopulationCategory::get(state_ptr[i], clock_ptr[i], schedule_ptr[i])] = 1;
+                        return {s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], 0, 0, 0, 0};
+                    });
+                }
+
+                if (lev == 0) {
+                    const auto& ds_arr = a_disease_stats[d]->const_array(mfi);
+                    reduce_ops.eval(mfi.tilebox(), *reduce_data[d],
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
+                    {
+                        return {0, 0, 0, 0, 0, 0, 0, 0,
+                                static_cast<Long>(ds_arr(i,j,k,0)), static_cast<Long>(ds_arr(i,j,k,1)),
+                                static_cast<Long>(ds_arr(i,j,k,2)), static_cast<Long>(ds_arr(i,j,k,3))};
+                    });
+                }
+            }
+        }
+    }
+
+    /* per disease: counted agents in each category, incremental counts, disease stats totals */
+    constexpr int ntot = 2*ncat + 4;
+    std::vector<Long> totals(ntot*n_disease);
+    for (int d = 0; d < n_disease; d++) {
+        auto r = reduce_data[d]->value(reduce_ops);
+        Long* t = &totals[ntot*d];
+        t[0] = amrex::get<0>(r);   t[1] = amrex::get<1>(r);   t[2] = amrex::get<2>(r);
+        t[3] = amrex::get<3>(r);   t[4] = amrex::get<4>(r);   t[5] = amrex::get<5>(r);
+        t[6] = amrex::get<6>(r);   t[7] = amrex::get<7>(r);
+        t[2*ncat+0] = amrex::get<8>(r);  t[2*ncat+1] = amrex::get<9>(r);
+        t[2*ncat+2] = amrex::get<10>(r); t[2*ncat+3] = amrex::get<11>(r);
+    }
+
+    if (m_incremental_counts) {
+        if (!m_population_counts_valid) {
+            m_population_counts.resize(n_disease);
+            for (int d = 0; d < n_disease; d++) {
+                for (int c = 0; c < ncat; c++) { m_population_counts[d][c] = totals[ntot*d+c]; }
+            }
+            m_population_counts_valid = true;
+        }
+        for (int d = 0; d < n_disease; d++) {
+            for (int c = 0; c < ncat; c++) { totals[ntot*d+ncat+c] = m_population_counts[d][c]; }
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(totals.data(), static_cast<int>(totals.size()),
+                                      ParallelDescriptor::IOProcessorNumber());
+
+    std::vector<DailySummary> summary(n_disease);
+    for (int d = 0; d < n_disease; d++) {
+        const Long* t = &totals[ntot*d];
+        if (m_incremental_counts && m_check_counts && ParallelDescriptor::IOProcessor()) {
+            for (int c = 0; c < ncat; c++) {
+                if (t[c] != t[ncat+c]) {
+                    amrex::Abort("getDailySummary: incremental count of category " + std::to_string(c)
+                                 + " of disease " + std::to_string(d) + " is " + std::to_string(t[ncat+c])
+                                 + ", but " + std::to_string(t[c]) + " agents were counted");
+                }
+            }
+        }
+        summary[d].counts = PopulationCategory::counts(m_incremental_counts ? t + ncat : t);
+        for (int k = 0; k < 4; k++) { summary[d].stats[k] = t[2*ncat+k]; }
+    }
+    return summary;
+}
+
+/*! \brief Adds the changes of #PopulationCategory recorded by a status update to the
+    incremental counts of this rank (see AgentContainer::getDailySummary()); the changes are
+    discarded if the counts have not been initialized yet, since the agents are then counted */
+void AgentContainer::addPopulationChanges (PopulationTally& a_tally /*!< changes of all diseases */)
+{
+    BL_PROFILE("AgentContainer::addPopulationChanges");
+    for (int d = 0; d < m_num_diseases; d++) {
+        const auto changes = a_tally.changes(d);
+        if (!m_incremental_counts || !m_population_counts_valid) { continue; }
+        for (int c = 0; c < PopulationCategory::ncat; c++) {
+            m_population_counts[d][c] += changes[c];
+        }
+    }
 }
 
 /*! \brief Interaction and movement of agents during morning commute
@@ -1305,18 +2217,28 @@ void AgentContainer::eveningCommute ( MultiFab& /*a_mask_behavior*/ /*!< Masking
     moveAgentsToHome();
 }
 
-/*! \brief Interaction of agents during day time - work and school */
+/*! \brief Interaction of agents during day time - work and school
+
+    If AgentContainer::useFusedInteractions(), the work, school, and neighborhood interactions
+    are computed in a single traversal (see #InteractionModFused).
+*/
 void AgentContainer::interactDay ( MultiFab& a_mask_behavior /*!< Masking behavior */ )
 {
     BL_PROFILE("AgentContainer::interactDay");
-    if (haveInteractionModel(ExaEpi::InteractionNames::work)) {
-        m_interactions[ExaEpi::InteractionNames::work]->interactAgents( *this, a_mask_behavior );
+    if (useFusedInteractions({ ExaEpi::InteractionModIdx::work,
+                               ExaEpi::InteractionModIdx::school,
+                               ExaEpi::InteractionModIdx::nborhood })) {
+        m_interact_day.interactAgents( *this, a_mask_behavior );
+        return;
+    }
+    if (haveInteractionModel(ExaEpi::InteractionModIdx::work)) {
+        interactionModel<ExaEpi::InteractionModIdx::work>().interactAgents( *this, a_mask_behavior );
     }
-    if (haveInteractionModel(ExaEpi::InteractionNames::school)) {
-        m_interactions[ExaEpi::InteractionNames::school]->interactAgents( *this, a_mask_behavior );
+    if (haveInteractionModel(ExaEpi::InteractionModIdx::school)) {
+        interactionModel<ExaEpi::InteractionModIdx::school>().interactAgents( *this, a_mask_behavior );
     }
-    if (haveInteractionModel(ExaEpi::InteractionNames::nborhood)) {
-        m_interactions[ExaEpi::InteractionNames::nborhood]->interactAgents( *this, a_mask_behavior );
+    if (haveInteractionModel(ExaEpi::InteractionModIdx::nborhood)) {
+        interactionModel<ExaEpi::InteractionModIdx::nborhood>().interactAgents( *this, a_mask_behavior );
     }
 }
 
@@ -1326,14 +2248,23 @@ void AgentContainer::interactEvening ( MultiFab& /*a_mask_behavior*/ /*!< Maskin
     BL_PROFILE("AgentContainer::interactEvening");
 }
 
-/*! \brief Interaction of agents during nighttime time - at home */
+/*! \brief Interaction of agents during nighttime time - at home
+
+    If AgentContainer::useFusedInteractions(), the home and neighborhood interactions are
+    computed in a single traversal (see #InteractionModFused).
+*/
 void AgentContainer::interactNight ( MultiFab& a_mask_behavior /*!< Masking behavior */ )
 {
     BL_PROFILE("AgentContainer::interactNight");
-    if (haveInteractionModel(ExaEpi::InteractionNames::home)) {
-        m_interactions[ExaEpi::InteractionNames::home]->interactAgents( *this, a_mask_behavior );
+    if (useFusedInteractions({ ExaEpi::InteractionModIdx::home,
+                               ExaEpi::InteractionModIdx::nborhood })) {
+        m_interact_night.interactAgents( *this, a_mask_behavior );
+        return;
+    }
+    if (haveInteractionModel(ExaEpi::InteractionModIdx::home)) {
+        interactionModel<ExaEpi::InteractionModIdx::home>().interactAgents( *this, a_mask_behavior );
     }
-    if (haveInteractionModel(ExaEpi::InteractionNames::nborhood)) {
-        m_interactions[ExaEpi::InteractionNames::nborhood]->interactAgents( *this, a_mask_behavior );
+    if (haveInteractionModel(ExaEpi::InteractionModIdx::nborhood)) {
+        interactionModel<ExaEpi::InteractionModIdx::nborhood>().interactAgents( *this, a_mask_behavior );
     }
 }
@@ -0,0 +1,159 @@
+/*! @file AggregationCube.cpp
+    \brief Contains the #ExaEpi::IO::AggregationCube class
+*/
+
+#include "AggregationCube.H"
+
+#include "AgentContainer.H"
+
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <fstream>
+
+using namespace amrex;
+
+namespace ExaEpi
+{
+namespace IO
+{
+
+namespace
+{
+    /*! Names of the group-by keys (#CubeKey) */
+    const char* const cube_key_names[CubeKey::nkeys]
+        = {"unit", "fips", "age_group", "withdrawn", "hospitalized"};
+
+    /*! Names of the categories (#PopulationCategory) */
+    const char* const category_names[PopulationCategory::ncat]
+        = {"never", "exposed", "immune", "susceptible", "dead",
+           "asymptomatic", "presymptomatic", "symptomatic"};
+}
+
+/*! \brief Constructor: read the parameters of the cube
+
+    + diag.cube_int: number of days between outputs (default: -1, never)
+    + diag.cube_keys: group-by keys, among "unit", "fips", "age_group", "withdrawn", and
+      "hospitalized" (default: "fips age_group")
+    + diag.cube_prefix: filename prefix (default: "cube")
+    + diag.cube_format: "sparse" (only the nonzero counts, the default) or "dense"
+*/
+AggregationCube::AggregationCube (const DemographicData& a_demo, /*!< demographic data */
+                                  const bool a_census /*!< are the agents initialized from census data? */)
+{
+    ParmParse pp("diag");
+    pp.query("cube_int", m_interval);
+    if (m_interval <= 0) { return; }
+    pp.query("cube_prefix", m_prefix);
+
+    std::string format = "sparse";
+    pp.query("cube_format", format);
+    if (format == "sparse") {
+        m_sparse = true;
+    } else if (format == "dense") {
+        m_sparse = false;
+    } else {
+        amrex::Abort("diag.cube_format type not recognized");
+    }
+
+    std::vector<std::string> keys = {"fips", "age_group"};
+    pp.queryarr("cube_keys", keys);
+    for (const auto& key : keys) {
+        const auto it = std::find(cube_key_names, cube_key_names + CubeKey::nkeys, key);
+        if (it == cube_key_names + CubeKey::nkeys) {
+            amrex::Abort("diag.cube_keys: key " + key + " not recognized");
+        }
+        const auto k = static_cast<int>(it - cube_key_names);
+        for (int kk = 0; kk < m_layout.nkeys; kk++) {
+            if (m_layout.keys[kk] == k) { amrex::Abort("diag.cube_keys: key " + key + " repeated"); }
+        }
+        if (((k == CubeKey::unit) || (k == CubeKey::fips)) && !a_census) {
+            amrex::Abort("diag.cube_keys: the unit and fips keys need census data");
+        }
+
+        int size = 2;
+        if (k == CubeKey::unit) {
+            size = a_demo.Nunit;
+        } else if (k == CubeKey::fips) {
+            m_fips.assign(a_demo.FIPS.begin(), a_demo.FIPS.begin() + a_demo.Nunit);
+            std::sort(m_fips.begin(), m_fips.end());
+            m_fips.erase(std::unique(m_fips.begin(), m_fips.end()), m_fips.end());
+            std::vector<int> fips_index(a_demo.Nunit);
+            for (int unit = 0; unit < a_demo.Nunit; unit++) {
+                fips_index[unit] = static_cast<int>(std::lower_bound(m_fips.begin(), m_fips.end(),
+                                                                     a_demo.FIPS[unit]) - m_fips.begin());
+            }
+            m_fips_index.resize(fips_index.size());
+            Gpu::copy(Gpu::hostToDevice, fips_index.begin(), fips_index.end(), m_fips_index.begin());
+            m_layout.fips_index = m_fips_index.data();
+            size = static_cast<int>(m_fips.size());
+        } else if (k == CubeKey::age_group) {
+            size = 5;
+        }
+        m_layout.keys[m_layout.nkeys] = k;
+        m_layout.sizes[m_layout.nkeys] = size;
+        m_layout.nkeys++;
+        m_layout.nbins *= size;
+    }
+}
+
+/*! \brief Count the agents and write the cube for a given day
+
+    The counts of each processor (see AgentContainer::generateCubeData()) are summed on the I/O
+    processor with a single reduction, which writes [diag.cube_prefix][day].csv: a header line
+    with the keys, then one line per bin, disease and category (only the nonzero counts if
+    sparse), with the values of the keys (the FIPS code for the fips key), the disease name,
+    the category (#PopulationCategory), and the number of agents.
+*/
+void AggregationCube::write (const AgentContainer& a_agents, /*!< agent container */
+                             const iMultiFab& a_unit_mf, /*!< unit number of each community */
+                             const std::vector<std::string>& a_disease_names, /*!< names of diseases */
+                             const int a_day /*!< day */) const
+{
+    BL_PROFILE("ExaEpi::IO::AggregationCube::write");
+    amrex::Print() << "Writing aggregation cube\n";
+
+    const auto n_disease = static_cast<int>(a_disease_names.size());
+    constexpr int ncat = PopulationCategory::ncat;
+
+    std::vector<Long> cube;
+    a_agents.generateCubeData(a_unit_mf, m_layout, cube);
+    ParallelDescriptor::ReduceLongSum(cube.data(), static_cast<int>(cube.size()),
+                                      ParallelDescriptor::IOProcessorNumber());
+    if (!ParallelDescriptor::IOProcessor()) { return; }
+
+    const std::string fn = amrex::Concatenate(m_prefix, a_day, 5) + ".csv";
+    std::ofstream ofs{fn, std::ofstream::out | std::ofstream::trunc};
+    if (!ofs.good()) { amrex::FileOpenFailed(fn); }
+
+    for (int k = 0; k < m_layout.nkeys; k++) {
+        ofs << cube_key_names[m_layout.keys[k]] << ",";
+    }
+    ofs << "disease,status,count\n";
+
+    std::vector<int> values(m_layout.nkeys);
+    for (int b = 0; b < m_layout.nbins; b++) {
+        /* values of the keys of bin b */
+        int r = b;
+        for (int k = m_layout.nkeys-1; k >= 0; k--) {
+            values[k] = r % m_layout.sizes[k];
+            r /= m_layout.sizes[k];
+            if (m_layout.keys[k] == CubeKey::fips) { values[k] = m_fips[values[k]]; }
+        }
+        for (int d = 0; d < n_disease; d++) {
+            for (int c = 0; c < ncat; c++) {
+                const Long count = cube[(static_cast<std::size_t>(b)*n_disease + d)*ncat + c];
+                if (m_sparse && (count == 0)) { continue; }
+                for (const auto v : values) { ofs << v << ","; }
+                ofs << a_disease_names[d] << "," << category_names[c] << "," << count << "\n";
+            }
+        }
+    }
+
+    ofs.close();
+    if (!ofs.good()) { amrex::Abort("problem writing aggregation cube"); }
+}
+
+}
+}
@@ -8,6 +8,38 @@
 
 using namespace amrex::literals;
 
+namespace
+{
+    /*! \brief Read a table of values by age group, if specified in the inputs */
+    template <typename T>
+    void queryAgeTable ( amrex::ParmParse& a_pp, /*!< ParmParse object */
+                         const char* a_key, /*!< input key */
+                         T* a_table /*!< table of DiseaseParm::num_age_groups values */ )
+    {
+        amrex::Vector<T> values(a_table, a_table + DiseaseParm::num_age_groups);
+        if (a_pp.queryarr(a_key, values, 0, DiseaseParm::num_age_groups)) {
+            for (int i = 0; i < DiseaseParm::num_age_groups; i++) { a_table[i] = values[i]; }
+        }
+    }
+}
+
+/*! \brief Read the clinical pathway tables of hospitalized agents
+
+    Each table has one value per age group (<5, 5-17, 18-29, 30-64, 65+).
+*/
+void DiseaseParm::readClinicalPathway (amrex::ParmParse& a_pp)
+{
+    queryAgeTable(a_pp, "hospitalization_prob", treatment_prob[0]);
+    queryAgeTable(a_pp, "icu_prob", treatment_prob[1]);
+    queryAgeTable(a_pp, "ventilator_prob", treatment_prob[2]);
+    queryAgeTable(a_pp, "hospital_death_prob", treatment_death_prob[0]);
+    queryAgeTable(a_pp, "icu_death_prob", treatment_death_prob[1]);
+    queryAgeTable(a_pp, "ventilator_death_prob", treatment_death_prob[2]);
+    queryAgeTable(a_pp, "hospital_days_short", hospital_days[0]);
+    queryAgeTable(a_pp, "hospital_days_long", hospital_days[1]);
+    queryAgeTable(a_pp, "hospital_short_frac", hospital_short_frac);
+}
+
 /*! \brief Initialize disease parameters
 
     Compute transmission probabilities for various situations based on disease
@@ -88,6 +120,14 @@ void DiseaseParm::Initialize ()
     }
 
     infect = 1.0_rt;
+
+    for (int i = 0; i < num_age_groups; i++) {
+        for (int k = 0; k < 2; k++) {
+            if ((hospital_days[k][i] < 1) || (hospital_days[k][i] >= treatment_level_days)) {
+                amrex::Abort("hospital stays must be between 1 and 9 days long");
+            }
+        }
+    }
 }
 
 /*! \brief Print disease parameters */
@@ -3,12 +3,23 @@
 */
 
 #include <AMReX_GpuContainers.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_PlotFileUtil.H>
+#include <AMReX_Random.H>
 #include <AMReX_REAL.H>
 #include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
 
 #include "IO.H"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
 #include <vector>
 
 using namespace amrex;
@@ -100,38 +111,27 @@ void writePlotFile (const AgentContainer& pc, /*!< Agent (particle) container */
         Vector<int> write_real_comp = {}, write_int_comp = {};
         Vector<std::string> real_varnames = {}, int_varnames = {};
         // non-disease-specific attributes
-        real_varnames.push_back("treatment_timer"); write_real_comp.push_back(1);
-        int_varnames.push_back ("age_group"); write_int_comp.push_back(static_cast<int>(step==0));
+        int_varnames.push_back ("traits"); write_int_comp.push_back(1);
         int_varnames.push_back ("family"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("home_i"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("home_j"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("work_i"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("work_j"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("nborhood"); write_int_comp.push_back(static_cast<int>(step==0));
-        int_varnames.push_back ("school"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("workgroup"); write_int_comp.push_back(static_cast<int>(step==0));
         int_varnames.push_back ("work_nborhood"); write_int_comp.push_back(static_cast<int>(step==0));
-        int_varnames.push_back ("withdrawn"); write_int_comp.push_back(1);
         // disease-specific (runtime-added) attributes
         if (num_diseases == 1) {
-            real_varnames.push_back("disease_counter"); write_real_comp.push_back(1);
             real_varnames.push_back("infection_prob"); write_real_comp.push_back(1);
-            real_varnames.push_back("incubation_period"); write_real_comp.push_back(static_cast<int>(step==0));
-            real_varnames.push_back("infectious_period"); write_real_comp.push_back(static_cast<int>(step==0));
-            real_varnames.push_back("symptomdev_period"); write_real_comp.push_back(static_cast<int>(step==0));
-            int_varnames.push_back ("status"); write_int_comp.push_back(1);
-            int_varnames.push_back ("strain"); write_int_comp.push_back(static_cast<int>(step==0));
-            int_varnames.push_back ("symptomatic"); write_int_comp.push_back(1);
+            int_varnames.push_back ("state"); write_int_comp.push_back(1);
+            int_varnames.push_back ("clock"); write_int_comp.push_back(1);
+            int_varnames.push_back ("schedule"); write_int_comp.push_back(1);
         } else {
             for (int d = 0; d < num_diseases; d++) {
-                real_varnames.push_back(disease_names[d]+"_disease_counter"); write_real_comp.push_back(1);
                 real_varnames.push_back(disease_names[d]+"_infection_prob"); write_real_comp.push_back(1);
-                real_varnames.push_back(disease_names[d]+"_incubation_period"); write_real_comp.push_back(static_cast<int>(step==0));
-                real_varnames.push_back(disease_names[d]+"_infectious_period"); write_real_comp.push_back(static_cast<int>(step==0));
-                real_varnames.push_back(disease_names[d]+"_symptomdev_period"); write_real_comp.push_back(static_cast<int>(step==0));
-                int_varnames.push_back (disease_names[d]+"_status"); write_int_comp.push_back(1);
-                int_varnames.push_back (disease_names[d]+"_strain"); write_int_comp.push_back(static_cast<int>(step==0));
-                int_varnames.push_back (disease_names[d]+"_symptomatic"); write_int_comp.push_back(1);
+                int_varnames.push_back (disease_names[d]+"_state"); write_int_comp.push_back(1);
+                int_varnames.push_back (disease_names[d]+"_clock"); write_int_comp.push_back(1);
+                int_varnames.push_back (disease_names[d]+"_schedule"); write_int_comp.push_back(1);
             }
         }
 
@@ -146,14 +146,21 @@ void writePlotFile (const AgentContainer& pc, /*!< Agent (particle) container */
 
 /*! \brief Writes diagnostic data by FIPS code
 
-    Writes a file with the total number of infected agents for each unit;
-    it writes out the number of infected agents in the same order as the units in the
-    census data file.
-    + Creates a output vector of size #DemographicData::Nunit (total number of units).
-    + Gets the disease status in agents from AgentContainer::generateCellData().
-    + On each processor, sets the unit-th element of the output vector to the number of
-      infected agents in the communities on this processor belonging to that unit.
-    + Sum across all processors and write to file.
+    Writes the number of agents of each unit, in the same order as the units in the census
+    data file.
+    + On each processor, count the agents of each unit with communities on this processor,
+      in each #PopulationCategory and for each disease, in a single pass over the agents (see
+      AgentContainer::generateUnitData()).
+    + Gather the counts of the units of each processor on the I/O processor, and add them up.
+    + With the "text" format (agent.aggregated_diag_format), write a file per step (and per
+      disease if more than one) with the total number of infected agents for each unit.
+    + With the "binary" format, append a record with all the counts to a single file,
+      [prefix].bin; the file is created, with a header, at step 0 (or if it does not exist).
+      The header is the 8 characters "EXAEPIUD", then the version (1), the number of units, the
+      number of diseases, and the number of categories (8) as 32-bit integers, then the FIPS
+      code of each unit as 32-bit integers. Each record is the step as a 32-bit integer, then
+      the counts as 64-bit integers, indexed by unit, then disease, then category (in the order
+      of #PopulationCategory); all in native byte order.
 */
 void writeFIPSData (const AgentContainer& agents, /*!< Agents (particle) container */
                     const iMultiFab& unit_mf, /*!< MultiFab with unit number of each community */
@@ -161,79 +168,755 @@ void writeFIPSData (const AgentContainer& agents, /*!< Agents (particle) contain
                     const iMultiFab& /*comm_mf*/,
                     const DemographicData& demo, /*!< Demographic data */
                     const std::string& prefix, /*!< Filename prefix */
+                    const std::string& format, /*!< "text" or "binary" */
                     const int num_diseases, /*!< Number of diseases */
                     const std::vector<std::string>& disease_names, /*!< Names of diseases */
                     const int step /*!< Current step */)
 {
-    static const int ncomp_d = 5;
-    static const int ncomp = ncomp_d*num_diseases + 4;
+    BL_PROFILE("ExaEpi::IO::writeFIPSData");
+    amrex::Print() << "Generating diagnostic data by FIPS code\n";
+
+    constexpr int ncat = PopulationCategory::ncat;
+    const int ncomp = num_diseases*ncat;
+
+    /* units with communities on this processor */
+    std::vector<int> units;
+    std::vector<int> local_unit(demo.Nunit, -1);
+    for (int unit = 0; unit < demo.Nunit; unit++) {
+        if (demo.Unit_on_proc[unit]) {
+            local_unit[unit] = static_cast<int>(units.size());
+            units.push_back(unit);
+        }
+    }
+    const auto nlocal = static_cast<int>(units.size());
+    amrex::Gpu::DeviceVector<int> local_unit_d(local_unit.size());
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice, local_unit.begin(), local_unit.end(), local_unit_d.begin());
 
-    static const int nlevs = std::max(0, agents.finestLevel()+1);
-    std::vector<std::unique_ptr<MultiFab>> mf_vec;
-    mf_vec.resize(nlevs);
-    for (int lev = 0; lev < nlevs; ++lev) {
-        mf_vec[lev] = std::make_unique<MultiFab>(   agents.ParticleBoxArray(lev),
-                                                    agents.ParticleDistributionMap(lev),
-                                                    ncomp,
-                                                    0 );
-        mf_vec[lev]->setVal(0.0);
-        agents.generateCellData(*mf_vec[lev]);
+    std::vector<Long> counts;
+    agents.generateUnitData(unit_mf, local_unit_d.data(), nlocal, counts);
+
+    /* gather the counts of the local units of all processors on the I/O processor */
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    std::vector<int> nunits(nprocs, 0), unit_disp(nprocs, 0), ncounts(nprocs, 0), count_disp(nprocs, 0);
+    ParallelDescriptor::Gather(&nlocal, 1, nunits.data(), ioproc);
+    int ntotal = 0;
+    for (int p = 0; p < nprocs; p++) {
+        unit_disp[p] = ntotal;
+        count_disp[p] = ntotal*ncomp;
+        ncounts[p] = nunits[p]*ncomp;
+        ntotal += nunits[p];
+    }
+    std::vector<int> all_units(ntotal);
+    std::vector<Long> all_counts(static_cast<std::size_t>(ntotal)*ncomp);
+    ParallelDescriptor::Gatherv(units.data(), nlocal, all_units.data(), nunits, unit_disp, ioproc);
+    ParallelDescriptor::Gatherv(counts.data(), nlocal*ncomp, all_counts.data(), ncounts, count_disp, ioproc);
+
+    if (!ParallelDescriptor::IOProcessor()) { return; }
+
+    std::vector<Long> data(static_cast<std::size_t>(demo.Nunit)*ncomp, 0);
+    for (int k = 0; k < ntotal; k++) {
+        for (int c = 0; c < ncomp; c++) {
+            data[static_cast<std::size_t>(all_units[k])*ncomp + c] += all_counts[static_cast<std::size_t>(k)*ncomp + c];
+        }
+    }
+
+    if (format == "binary") {
+        const std::string fn = prefix + ".bin";
+        const bool create = (step == 0) || !amrex::FileExists(fn);
+        std::ofstream ofs{fn, create ? (std::ofstream::out | std::ofstream::trunc | std::ofstream::binary)
+                                     : (std::ofstream::out | std::ofstream::app | std::ofstream::binary)};
+        if (!ofs.good()) { amrex::FileOpenFailed(fn); }
+        if (create) {
+            const std::int32_t header[4] = {1, demo.Nunit, num_diseases, ncat};
+            ofs.write("EXAEPIUD", 8);
+            ofs.write(reinterpret_cast<const char*>(header), sizeof(header));
+            for (int unit = 0; unit < demo.Nunit; unit++) {
+                const auto fips = static_cast<std::int32_t>(demo.FIPS[unit]);
+                ofs.write(reinterpret_cast<const char*>(&fips), sizeof(fips));
+            }
+        }
+        const auto istep = static_cast<std::int32_t>(step);
+        ofs.write(reinterpret_cast<const char*>(&istep), sizeof(istep));
+        for (const auto& item : data) {
+            const auto value = static_cast<std::int64_t>(item);
+            ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        ofs.close();
+        if (!ofs.good()) { amrex::Abort("problem writing aggregated diagnostic data"); }
+        return;
     }
 
     for (int d = 0; d < num_diseases; d++) {
+        std::string fn = amrex::Concatenate(prefix, step, 5);
+        if (num_diseases > 1) { fn += ("_" + disease_names[d]); }
+        std::ofstream ofs{fn, std::ofstream::out | std::ofstream::app};
+
+        // set precision
+        ofs << std::fixed << std::setprecision(14) << std::scientific;
+
+        // loop over units and write the number of infected agents
+        for (int unit = 0; unit < demo.Nunit; unit++) {
+            const Long* c = &data[(static_cast<std::size_t>(unit)*num_diseases + d)*ncat];
+            const Long num_infected = c[PopulationCategory::exposed] + c[PopulationCategory::asymptomatic]
+                                    + c[PopulationCategory::presymptomatic] + c[PopulationCategory::symptomatic];
+            ofs << " " << static_cast<Real>(num_infected);
+        }
+
+        ofs << std::endl;
+        ofs.close();
+    }
+}
+
+/*! \brief Remove the records of the steps a_step and later from the binary aggregated
+    diagnostic data file (see writeFIPSData()), when restarting on step a_step, so that the
+    records of the steps simulated again are not duplicated
+*/
+void trimFIPSData (const std::string& prefix, /*!< Filename prefix */
+                   const DemographicData& demo, /*!< Demographic data */
+                   const int num_diseases, /*!< Number of diseases */
+                   const int step /*!< Restart step */)
+{
+    BL_PROFILE("ExaEpi::IO::trimFIPSData");
+    const std::string fn = prefix + ".bin";
+    if (!ParallelDescriptor::IOProcessor() || !amrex::FileExists(fn)) { return; }
+
+    std::string contents;
+    {
+        std::ifstream ifs{fn, std::ios::in|std::ios::binary};
+        contents.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    const std::size_t header_size = 8 + 4*sizeof(std::int32_t) + demo.Nunit*sizeof(std::int32_t);
+    const std::size_t record_size = sizeof(std::int32_t)
+        + static_cast<std::size_t>(demo.Nunit)*num_diseases*PopulationCategory::ncat*sizeof(std::int64_t);
+    if (contents.size() < header_size) { return; }
+
+    std::size_t size = header_size;
+    while (size + record_size <= contents.size()) {
+        std::int32_t record_step;
+        std::memcpy(&record_step, contents.data() + size, sizeof(record_step));
+        if (record_step >= step) { break; }
+        size += record_size;
+    }
 
-        amrex::Print() << "Generating diagnostic data by FIPS code "
-                       << "for " << disease_names[d] << "\n";
+    std::ofstream ofs{fn, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary};
+    if (!ofs.good()) { amrex::FileOpenFailed(fn); }
+    ofs.write(contents.data(), static_cast<std::streamsize>(size));
+    ofs.close();
+    if (!ofs.good()) { amrex::Abort("problem writing aggregated diagnostic data"); }
+}
 
-        std::vector<amrex::Real> data(demo.Nunit, 0.0);
-        amrex::Gpu::DeviceVector<amrex::Real> d_data(data.size(), 0.0);
-        amrex::Real* const AMREX_RESTRICT data_ptr = d_data.dataPtr();
+namespace
+{
+    /*! \brief Write the community data (number of residents, unit, FIPS code, and community
+               number) to a checkpoint or population cache directory */
+    void writeCommunityData (const std::string& a_dir, /*!< directory */
+                             const iMultiFab& a_num_residents, /*!< number of residents */
+                             const iMultiFab& a_unit_mf, /*!< unit number of each community */
+                             const iMultiFab& a_FIPS_mf, /*!< FIPS code and census tract ID */
+                             const iMultiFab& a_comm_mf /*!< community number */)
+    {
+        amrex::Write(a_num_residents, a_dir + "/num_residents");
+        amrex::Write(a_unit_mf, a_dir + "/unit_mf");
+        amrex::Write(a_FIPS_mf, a_dir + "/FIPS_mf");
+        amrex::Write(a_comm_mf, a_dir + "/comm_mf");
+    }
 
-        for (int lev = 0; lev < nlevs; ++lev) {
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
-#endif
+    /*! \brief Read the community data written by writeCommunityData(), and set the units with
+               communities on this processor (as AgentContainer::initAgentsCensus() does) */
+    void readCommunityData (const std::string& a_dir, /*!< directory */
+                            iMultiFab& a_num_residents, /*!< number of residents */
+                            iMultiFab& a_unit_mf, /*!< unit number of each community */
+                            iMultiFab& a_FIPS_mf, /*!< FIPS code and census tract ID */
+                            iMultiFab& a_comm_mf, /*!< community number */
+                            DemographicData& a_demo /*!< demographic data */)
+    {
+        amrex::Read(a_num_residents, a_dir + "/num_residents");
+        amrex::Read(a_unit_mf, a_dir + "/unit_mf");
+        amrex::Read(a_FIPS_mf, a_dir + "/FIPS_mf");
+        amrex::Read(a_comm_mf, a_dir + "/comm_mf");
+
+        if (a_demo.Unit_on_proc_d.empty()) { return; }
+        const int nunit = a_demo.Nunit;
+        auto unit_on_proc = a_demo.Unit_on_proc_d.data();
+        for (MFIter mfi(a_unit_mf); mfi.isValid(); ++mfi) {
+            const auto unit_arr = a_unit_mf.const_array(mfi);
+            ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
             {
-                for (MFIter mfi(*mf_vec[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
-                {
-                    auto unit_arr = unit_mf[mfi].array();
-                    auto cell_data_arr = (*mf_vec[lev])[mfi].array();
-
-                    auto bx = mfi.tilebox();
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                        {
-                            int unit = unit_arr(i, j, k);  // which FIPS
-                            int num_infected = int(cell_data_arr(i, j, k, 2));
-                            amrex::Gpu::Atomic::AddNoRet(&data_ptr[unit], (amrex::Real) num_infected);
-                        });
-                }
+                const int unit = unit_arr(i, j, k);
+                if ((unit >= 0) && (unit < nunit)) { unit_on_proc[unit] = 1; }
+            });
+        }
+        a_demo.CopyToHostAsync(a_demo.Unit_on_proc_d, a_demo.Unit_on_proc);
+        Gpu::streamSynchronize();
+    }
+
+    /*! \brief FNV-1a hash of a_n bytes, continuing from a_hash */
+    std::uint64_t hashBytes (const char* a_data, /*!< bytes */
+                             const std::size_t a_n, /*!< number of bytes */
+                             std::uint64_t a_hash /*!< hash of the previous bytes */)
+    {
+        for (std::size_t k = 0; k < a_n; k++) {
+            a_hash ^= static_cast<unsigned char>(a_data[k]);
+            a_hash *= 1099511628211ULL;
+        }
+        return a_hash;
+    }
+
+    /*! \brief FNV-1a hash of the contents of a file, continuing from a_hash */
+    std::uint64_t hashFile (const std::string& a_filename, /*!< file */
+                            std::uint64_t a_hash /*!< hash of the previous bytes */)
+    {
+        std::ifstream ifs{a_filename, std::ios::in|std::ios::binary};
+        if (!ifs.good()) { amrex::FileOpenFailed(a_filename); }
+        std::vector<char> buffer(1 << 20);
+        while (ifs) {
+            ifs.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            a_hash = hashBytes(buffer.data(), static_cast<std::size_t>(ifs.gcount()), a_hash);
+        }
+        return a_hash;
+    }
+
+    /*! Version of the population cache format */
+    const std::string population_cache_version = "ExaEpi population cache version 2";
+
+    /*! Write the state of the host random number generators of this processor to
+        [a_dir]/RandomState_[p] */
+    void writeRandomState (const std::string& a_dir)
+    {
+        const std::string fn = a_dir + "/RandomState_" + std::to_string(ParallelDescriptor::MyProc());
+        std::ofstream ofs{fn, std::ofstream::out | std::ofstream::trunc};
+        if (!ofs.good()) { amrex::FileOpenFailed(fn); }
+        ofs << OpenMP::get_max_threads() << "\n";
+        amrex::SaveRandomState(ofs);
+        ofs.close();
+        if (!ofs.good()) { amrex::Abort("problem writing " + fn); }
+    }
+
+    /*! Restore the state of the host random number generators of this processor written by
+        writeRandomState() */
+    void readRandomState (const std::string& a_dir)
+    {
+        const std::string fn = a_dir + "/RandomState_" + std::to_string(ParallelDescriptor::MyProc());
+        std::ifstream ifs{fn, std::ifstream::in};
+        if (!ifs.good()) { amrex::FileOpenFailed(fn); }
+        int nthreads = 0;
+        ifs >> nthreads;
+        amrex::RestoreRandomState(ifs, nthreads, 0);
+    }
+}
+
+/*! \brief Write a checkpoint, from which the simulation can be restarted (agent.restart) on
+    any number of processors
+
+    Creates the directory [prefix][step] (agent.chk_prefix, with the step padded to 5 digits)
+    with:
+    + Header: the version, the step, time, and status-update flag of #CheckpointData, the number
+      of status updates of the agents (see AgentContainer::day()), then, for each disease, its
+      name, peak number of infected, day of peak, and cumulative deaths.
+    + agents: all the components of the agents (see AgentContainer::checkpoint()).
+    + num_residents, unit_mf, FIPS_mf, comm_mf, and disease_stats_[d]: the MultiFabs, written
+      with the parallel MultiFab I/O of AMReX.
+    + RandomState_[p]: the state of the host random number generators of processor p.
+*/
+void writeCheckpoint (AgentContainer& pc, /*!< Agent (particle) container */
+                      const iMultiFab& num_residents, /*!< MultiFab with number of residents */
+                      const iMultiFab& unit_mf, /*!< MultiFab with unit number of each community */
+                      const iMultiFab& FIPS_mf, /*!< MultiFab with FIPS code and census tract ID */
+                      const iMultiFab& comm_mf, /*!< MultiFab of community number */
+                      const Vector<std::unique_ptr<MultiFab> >& disease_stats, /*!< Disease stats */
+                      const std::vector<std::string>& disease_names, /*!< Names of diseases */
+                      const CheckpointData& data, /*!< State of the main loop */
+                      const std::string& prefix /*!< Directory name prefix */)
+{
+    BL_PROFILE("ExaEpi::IO::writeCheckpoint");
+    const std::string dir = amrex::Concatenate(prefix, data.step, 5);
+    amrex::Print() << "Writing checkpoint " << dir << "\n";
+
+    amrex::UtilCreateCleanDirectory(dir, true);
+    pc.checkpoint(dir);
+
+    writeCommunityData(dir, num_residents, unit_mf, FIPS_mf, comm_mf);
+    for (std::size_t d = 0; d < disease_stats.size(); d++) {
+        VisMF::Write(*disease_stats[d], dir + "/disease_stats_" + std::to_string(d));
+    }
+
+    writeRandomState(dir);
+
+    if (ParallelDescriptor::IOProcessor()) {
+        const std::string fn = dir + "/Header";
+        std::ofstream ofs{fn, std::ofstream::out | std::ofstream::trunc};
+        if (!ofs.good()) { amrex::FileOpenFailed(fn); }
+        ofs << std::setprecision(std::numeric_limits<Real>::max_digits10);
+        ofs << "ExaEpi checkpoint version 1\n";
+        ofs << data.step << " " << data.cur_time << " " << data.status_updated << " " << pc.day() << "\n";
+        ofs << ParallelDescriptor::NProcs() << " " << disease_names.size() << "\n";
+        for (std::size_t d = 0; d < disease_names.size(); d++) {
+            ofs << disease_names[d] << " " << data.num_infected_peak[d] << " "
+                << data.step_of_peak[d] << " " << data.cumulative_deaths[d] << "\n";
+        }
+        ofs.close();
+        if (!ofs.good()) { amrex::Abort("problem writing checkpoint"); }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+/*! \brief Read a checkpoint written by writeCheckpoint()
+
+    The MultiFabs must be defined, with the BoxArray of the run that wrote the checkpoint
+    (which only depends on the inputs) and any DistributionMapping; the agents are
+    redistributed (see AgentContainer::restart()), and the units with communities on this
+    processor (DemographicData::Unit_on_proc) are set from unit_mf. The host random number
+    generators are restored if the number of processors is the same as when the checkpoint was
+    written; otherwise, they are left as seeded, so that only the counter-based generator
+    (agent.counter_rng) gives the same results as a run without restart.
+*/
+void readCheckpoint (AgentContainer& pc, /*!< Agent (particle) container */
+                     iMultiFab& num_residents, /*!< MultiFab with number of residents */
+                     iMultiFab& unit_mf, /*!< MultiFab with unit number of each community */
+                     iMultiFab& FIPS_mf, /*!< MultiFab with FIPS code and census tract ID */
+                     iMultiFab& comm_mf, /*!< MultiFab of community number */
+                     Vector<std::unique_ptr<MultiFab> >& disease_stats, /*!< Disease stats */
+                     DemographicData& demo, /*!< Demographic data */
+                     const std::vector<std::string>& disease_names, /*!< Names of diseases */
+                     CheckpointData& data, /*!< State of the main loop */
+                     const std::string& dir /*!< Checkpoint directory */)
+{
+    BL_PROFILE("ExaEpi::IO::readCheckpoint");
+    amrex::Print() << "Restarting from checkpoint " << dir << "\n";
+
+    int day = 0, nprocs = 0;
+    {
+        Vector<char> buffer;
+        ParallelDescriptor::ReadAndBcastFile(dir + "/Header", buffer);
+        std::istringstream is{std::string(buffer.dataPtr())};
+        std::string line;
+        std::getline(is, line);
+        if (line != "ExaEpi checkpoint version 1") {
+            amrex::Abort("readCheckpoint: " + dir + " is not an ExaEpi checkpoint");
+        }
+        std::size_t num_diseases = 0;
+        is >> data.step >> data.cur_time >> data.status_updated >> day >> nprocs >> num_diseases;
+        if (num_diseases != disease_names.size()) {
+            amrex::Abort("readCheckpoint: the number of diseases differs from the checkpoint");
+        }
+        data.num_infected_peak.resize(num_diseases);
+        data.step_of_peak.resize(num_diseases);
+        data.cumulative_deaths.resize(num_diseases);
+        for (std::size_t d = 0; d < num_diseases; d++) {
+            std::string name;
+            is >> name >> data.num_infected_peak[d] >> data.step_of_peak[d] >> data.cumulative_deaths[d];
+            if (name != disease_names[d]) {
+                amrex::Abort("readCheckpoint: disease " + disease_names[d] + " not in the checkpoint");
             }
         }
+        if (!is) { amrex::Abort("readCheckpoint: problem reading " + dir + "/Header"); }
+    }
+
+    pc.restart(dir, day);
+
+    readCommunityData(dir, num_residents, unit_mf, FIPS_mf, comm_mf, demo);
+    for (std::size_t d = 0; d < disease_stats.size(); d++) {
+        VisMF::Read(*disease_stats[d], dir + "/disease_stats_" + std::to_string(d));
+    }
 
-        // blocking copy from device to host
-        amrex::Gpu::copy(amrex::Gpu::deviceToHost,
-                         d_data.begin(), d_data.end(), data.begin());
+    if (nprocs == ParallelDescriptor::NProcs()) {
+        readRandomState(dir);
+    } else {
+        amrex::Print() << "Checkpoint written on " << nprocs << " processors: "
+                       << "the random number generators are not restored\n";
+    }
+}
 
-        // reduced sum over mpi ranks
-        ParallelDescriptor::ReduceRealSum
-            (data.data(), data.size(), ParallelDescriptor::IOProcessorNumber());
+/*! \brief Name of the population cache directory of this run, or an empty string if the
+    cache is not used (agent.population_cache)
 
-        if (ParallelDescriptor::IOProcessor())
+    The name is [agent.population_cache]_[key], where the key is a hash of the version of the
+    cache format, of the contents of the census and worker flow files, of agent.seed,
+    agent.counter_rng, agent.max_grid_size and the number of diseases, and, without the
+    counter-based generator (since the random numbers then depend on the decomposition), of
+    the number of processors and threads; so a cache is only used by runs that would
+    synthesize the same agents.
+*/
+std::string populationCacheName (const TestParams& params /*!< Test parameters */)
+{
+    BL_PROFILE("ExaEpi::IO::populationCacheName");
+    if (params.population_cache.empty()) { return ""; }
+
+    std::uint64_t hash = hashBytes(population_cache_version.data(), population_cache_version.size(),
+                                   14695981039346656037ULL);
+    if (ParallelDescriptor::IOProcessor()) {
+        hash = hashFile(params.census_filename, hash);
+        hash = hashFile(params.workerflow_filename, hash);
+    }
+    ParallelDescriptor::Bcast(&hash, 1, ParallelDescriptor::IOProcessorNumber());
+
+    ParmParse pp("agent");
+    Long seed = 0;
+    bool counter_rng = false;
+    pp.query("seed", seed);
+    pp.query("counter_rng", counter_rng);
+    // the grids and the per-disease agent data must match the run that reads the cache
+    std::vector<Long> key = {seed, counter_rng ? 1 : 0, params.max_grid_size, params.num_diseases};
+    if (!counter_rng) {
+        key.push_back(ParallelDescriptor::NProcs());
+        key.push_back(OpenMP::get_max_threads());
+    }
+    hash = hashBytes(reinterpret_cast<const char*>(key.data()), key.size()*sizeof(Long), hash);
+
+    std::ostringstream name;
+    name << params.population_cache << "_" << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return name.str();
+}
+
+/*! \brief Write the synthesized agents and community data to a population cache
+
+    Called after the agents are created from the census and worker flow data (before the
+    initial cases are set); the directory has the same layout as a checkpoint (see
+    writeCheckpoint()), with the agents written with the parallel particle I/O of AMReX, and
+    the state of the host random number generators after the synthesis, so that a run that
+    reads the cache continues with the same random numbers as the one that wrote it. The
+    Header file is written last, so that an incomplete cache is not used.
+*/
+void writePopulationCache (AgentContainer& pc, /*!< Agent (particle) container */
+                           const iMultiFab& num_residents, /*!< MultiFab with number of residents */
+                           const iMultiFab& unit_mf, /*!< MultiFab with unit number of each community */
+                           const iMultiFab& FIPS_mf, /*!< MultiFab with FIPS code and census tract ID */
+                           const iMultiFab& comm_mf, /*!< MultiFab of community number */
+                           const std::string& dir /*!< Cache directory (see populationCacheName()) */)
+{
+    BL_PROFILE("ExaEpi::IO::writePopulationCache");
+    amrex::Print() << "Writing population cache " << dir << "\n";
+
+    amrex::UtilCreateCleanDirectory(dir, true);
+    pc.checkpoint(dir);
+    writeCommunityData(dir, num_residents, unit_mf, FIPS_mf, comm_mf);
+    writeRandomState(dir);
+    ParallelDescriptor::Barrier();
+
+    if (ParallelDescriptor::IOProcessor()) {
+        const std::string fn = dir + "/Header";
+        std::ofstream ofs{fn, std::ofstream::out | std::ofstream::trunc};
+        if (!ofs.good()) { amrex::FileOpenFailed(fn); }
+        ofs << population_cache_version << "\n";
+        ofs.close();
+        if (!ofs.good()) { amrex::Abort("problem writing population cache"); }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+/*! \brief Read the agents and community data from a population cache, if it exists
+
+    Returns false if there is no complete cache in dir, in which case the agents must be
+    synthesized (and the cache written, see writePopulationCache()). The agents are read
+    directly into the particle tiles and redistributed (see AgentContainer::restart()). Without
+    agent.counter_rng, the host random number generators are also restored (the cache key then
+    includes the number of processors and threads); with it, the synthesis does not use them.
+*/
+bool readPopulationCache (AgentContainer& pc, /*!< Agent (particle) container */
+                          iMultiFab& num_residents, /*!< MultiFab with number of residents */
+                          iMultiFab& unit_mf, /*!< MultiFab with unit number of each community */
+                          iMultiFab& FIPS_mf, /*!< MultiFab with FIPS code and census tract ID */
+                          iMultiFab& comm_mf, /*!< MultiFab of community number */
+                          DemographicData& demo, /*!< Demographic data */
+                          const std::string& dir /*!< Cache directory (see populationCacheName()) */)
+{
+    BL_PROFILE("ExaEpi::IO::readPopulationCache");
+    if (dir.empty()) { return false; }
+
+    int found = 0;
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ifstream ifs{dir + "/Header"};
+        std::string line;
+        found = (std::getline(ifs, line) && (line == population_cache_version)) ? 1 : 0;
+    }
+    ParallelDescriptor::Bcast(&found, 1, ParallelDescriptor::IOProcessorNumber());
+    if (!found) { return false; }
+
+    amrex::Print() << "Reading population cache " << dir << "\n";
+    pc.restart(dir, 0);
+    readCommunityData(dir, num_residents, unit_mf, FIPS_mf, comm_mf, demo);
+    if (!pc.counterRNG()) { readRandomState(dir); }
+    return true;
+}
+
+namespace
+{
+    /*! Column names of the daily summary output files */
+    const char* const daily_summary_names[DailySummaryWriter::ncols]
+        = {"Day", "Never", "Infected", "Immune", "Deaths", "Hospitalized", "Ventilated", "ICU",
+           "Exposed", "Asymptomatic", "Presymptomatic", "Symptomatic"};
+
+    /*! Column widths of the text format */
+    const int daily_summary_widths[DailySummaryWriter::ncols]
+        = {5, 10, 10, 10, 10, 15, 15, 10, 10, 15, 15, 15};
+
+    /*! Size of a column name in the header of the binary format */
+    constexpr int binary_name_size = 16;
+}
+
+/*! \brief Constructor: on the I/O processor, create the output files (diag.output_filename),
+    write their headers, and start the background writer thread if asynchronous
+
+    When restarting on day a_first_day > 0, the existing output files are kept up to the row of
+    that day (excluded), so that the rows of the days simulated again are not duplicated.
+
+    The binary format starts with the 8 characters "EXAEPITS", a 32-bit integer version (1) and
+    the number of columns, and the column names (16 characters each, null-padded); each row is
+    then the day and the counts as 64-bit integers, in native byte order.
+*/
+DailySummaryWriter::DailySummaryWriter (const std::vector<std::string>& a_filenames, /*!< output file of each disease */
+                                        const std::string& a_format, /*!< "text", "csv", or "binary" */
+                                        const int a_flush_int, /*!< number of days between flushes */
+                                        const bool a_async, /*!< write from a background thread? */
+                                        const int a_first_day /*!< first day (restart step) */)
+    : m_active(ParallelDescriptor::IOProcessor()),
+      m_flush_int(std::max(a_flush_int, 1)),
+      m_last_flush_day(a_first_day),
+      m_async(a_async),
+      m_filenames(a_filenames)
+{
+    if (a_format == "text") {
+        m_format = Format::text;
+    } else if (a_format == "csv") {
+        m_format = Format::csv;
+    } else if (a_format == "binary") {
+        m_format = Format::binary;
+    } else {
+        amrex::Abort("diag.output_format type not recognized");
+    }
+
+    if (!m_active) { return; }
+
+    m_files.resize(m_filenames.size());
+    for (std::size_t d = 0; d < m_filenames.size(); d++) {
+        openFile(static_cast<int>(d), a_first_day);
+    }
+
+    if (m_async) {
+        m_thread = std::thread(&DailySummaryWriter::run, this);
+    }
+}
+
+/*! \brief Destructor: write the remaining rows and close the files (see finalize()) */
+DailySummaryWriter::~DailySummaryWriter ()
+{
+    finalize();
+}
+
+/*! \brief Add the daily summary of all diseases on a given day
+
+    The summary only needs to be correct on the I/O processor (see
+    AgentContainer::getDailySummary()). With asynchronous output, the rows are written later by
+    the background thread.
+*/
+void DailySummaryWriter::write (const int a_day, /*!< day */
+                                const std::vector<DailySummary>& a_summary /*!< summary of each disease */)
+{
+    BL_PROFILE("DailySummaryWriter::write");
+    if (!m_active) { return; }
+    if (m_failed) { amrex::Abort("problem writing output file"); }
+
+    std::vector<Row> rows(a_summary.size());
+    for (std::size_t d = 0; d < a_summary.size(); d++) {
+        const auto& counts = a_summary[d].counts;
+        const auto& mmc = a_summary[d].stats;
+        rows[d] = Row{static_cast<int>(d), {a_day, counts[0], counts[1], counts[2], counts[4],
+                                            mmc[0], mmc[1], mmc[2],
+                                            counts[5], counts[6], counts[7], counts[8]}};
+    }
+
+    if (m_async) {
         {
-            std::string fn = amrex::Concatenate(prefix, step, 5);
-            if (num_diseases > 1) { fn += ("_" + disease_names[d]); }
-            std::ofstream ofs{fn, std::ofstream::out | std::ofstream::app};
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.insert(m_pending.end(), rows.begin(), rows.end());
+        }
+        m_cv.notify_one();
+    } else {
+        writeRows(rows);
+        if (m_failed) { amrex::Abort("problem writing output file"); }
+    }
+}
 
-            // set precision
-            ofs << std::fixed << std::setprecision(14) << std::scientific;
+/*! \brief Wait until the background thread has written all the rows, and flush the files
 
-            // loop over data size and write
-            for (const auto& item : data) {
-                ofs << " " << item;
+    Called before writing a checkpoint, so that the files hold all the rows up to the
+    checkpoint day if the run is restarted from it.
+*/
+void DailySummaryWriter::flush ()
+{
+    BL_PROFILE("DailySummaryWriter::flush");
+    if (!m_active) { return; }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_async) {
+        m_done_cv.wait(lock, [this] { return m_pending.empty() && !m_writing; });
+    }
+    for (auto& file : m_files) {
+        file.flush();
+        if (!file.good()) { m_failed = true; }
+    }
+    if (m_failed) { amrex::Abort("problem writing output file"); }
+}
+
+/*! \brief Write the remaining rows, flush and close the files, and stop the background thread */
+void DailySummaryWriter::finalize ()
+{
+    BL_PROFILE("DailySummaryWriter::finalize");
+    if (!m_active) { return; }
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+    for (auto& file : m_files) {
+        if (!file.is_open()) { continue; }
+        file.flush();
+        file.close();
+        if (!file.good()) { m_failed = true; }
+    }
+    m_active = false;
+    if (m_failed) { amrex::Abort("problem writing output file"); }
+}
+
+/*! \brief Background thread: write the pending rows until finalize() is called */
+void DailySummaryWriter::run ()
+{
+    std::vector<Row> rows;
+    while (true) {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            rows.swap(m_pending);
+            stop = m_stop;
+            m_writing = true;
+        }
+        writeRows(rows);
+        rows.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writing = false;
+        }
+        m_done_cv.notify_all();
+        if (stop) { break; }
+    }
+}
+
+/*! \brief Write rows to the files of their diseases, and flush the files every
+    diag.output_flush_int days */
+void DailySummaryWriter::writeRows (const std::vector<Row>& a_rows /*!< rows */)
+{
+    for (const auto& row : a_rows) {
+        auto& file = m_files[row.disease];
+        if (m_format == Format::text) {
+            for (int c = 0; c < ncols; c++) {
+                file << std::setw(daily_summary_widths[c]) << row.values[c];
+            }
+            file << "\n";
+        } else if (m_format == Format::csv) {
+            for (int c = 0; c < ncols; c++) {
+                file << (c > 0 ? "," : "") << row.values[c];
             }
+            file << "\n";
+        } else {
+            for (int c = 0; c < ncols; c++) {
+                const auto value = static_cast<std::int64_t>(row.values[c]);
+                file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+        }
+        if (!file.good()) { m_failed = true; }
 
-            ofs << std::endl;
-            ofs.close();
+        const auto day = static_cast<int>(row.values[0]);
+        if (day - m_last_flush_day >= m_flush_int) {
+            for (auto& f : m_files) {
+                f.flush();
+                if (!f.good()) { m_failed = true; }
+            }
+            m_last_flush_day = day;
+        }
+    }
+}
+
+/*! \brief Open the output file of disease a_d, and write its header, or, when restarting on
+    day a_first_day > 0 and the file exists, its header and rows of the previous days */
+void DailySummaryWriter::openFile (const int a_d, /*!< disease index */
+                                   const int a_first_day /*!< first day */)
+{
+    const auto& fn = m_filenames[a_d];
+    const auto binary = (m_format == Format::binary) ? std::ios::binary : std::ios::openmode{};
+
+    std::string kept;
+    if ((a_first_day > 0) && amrex::FileExists(fn)) {
+        std::ifstream ifs{fn, std::ios::in|binary};
+        const std::string contents{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+        if (m_format == Format::binary) {
+            const std::size_t header_size = 16 + ncols*binary_name_size;
+            const std::size_t row_size = ncols*sizeof(std::int64_t);
+            if (contents.size() >= header_size) {
+                std::size_t size = header_size;
+                while (size + row_size <= contents.size()) {
+                    std::int64_t day;
+                    std::memcpy(&day, contents.data() + size, sizeof(day));
+                    if (day >= a_first_day) { break; }
+                    size += row_size;
+                }
+                kept = contents.substr(0, size);
+            }
+        } else {
+            std::istringstream iss{contents};
+            std::string line;
+            bool header = true;
+            while (std::getline(iss, line)) {
+                if (!header) {
+                    std::istringstream row{line};
+                    Long day;
+                    if (!(row >> day) || (day >= a_first_day)) { break; }
+                }
+                kept += line + "\n";
+                header = false;
+            }
+        }
+    }
+
+    auto& file = m_files[a_d];
+    file.open(fn.c_str(), std::ios::out|std::ios::trunc|binary);
+    if (!file.good()) {
+        amrex::FileOpenFailed(fn);
+    }
+    if (kept.empty()) {
+        writeHeader(file);
+    } else {
+        file.write(kept.data(), static_cast<std::streamsize>(kept.size()));
+    }
+    file.flush();
+}
+
+/*! \brief Write the header of an output file */
+void DailySummaryWriter::writeHeader (std::ofstream& a_file /*!< output file */)
+{
+    if (m_format == Format::text) {
+        for (int c = 0; c < ncols; c++) {
+            // the line break is part of the last (padded) column name
+            a_file << std::setw(daily_summary_widths[c])
+                   << (std::string(daily_summary_names[c]) + ((c+1 < ncols) ? "" : "\n"));
+        }
+    } else if (m_format == Format::csv) {
+        for (int c = 0; c < ncols; c++) {
+            a_file << (c > 0 ? "," : "") << daily_summary_names[c];
+        }
+        a_file << "\n";
+    } else {
+        const std::int32_t version = 1, n = ncols;
+        a_file.write("EXAEPITS", 8);
+        a_file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        a_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        for (int c = 0; c < ncols; c++) {
+            char name[binary_name_size] = {};
+            std::strncpy(name, daily_summary_names[c], binary_name_size-1);
+            a_file.write(name, binary_name_size);
         }
     }
 }
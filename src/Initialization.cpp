@@ -14,10 +14,59 @@
 #include <AMReX_Random.H>
 #include <AMReX_VisMF.H>
 
+#include <algorithm>
 #include <fstream>
+#include <vector>
 
 using namespace amrex;
 
+namespace
+{
+    /*! \brief Worker-flow record: number of workers from a home unit to a work unit */
+    struct FlowRecord
+    {
+        int from;               /*!< home unit */
+        int to;                 /*!< work unit */
+        unsigned int number;    /*!< number of workers */
+    };
+
+    /*! \brief Sparse (CSR) worker-flow table (see ExaEpi::Initialization::read_workerflow())
+
+        Row u holds, in increasing order of work unit, the work units with workers from home
+        unit u (entries offsets[u] to offsets[u+1]-1), with the cumulative (scaled) numbers of
+        workers; memory is proportional to the number of nonzero flows.
+    */
+    struct WorkerFlowTable
+    {
+        const int* offsets;             /*!< start of the entries of each home unit */
+        const int* to;                  /*!< work unit of each entry */
+        const unsigned int* cumulative; /*!< cumulative number of workers of each entry */
+
+        /*! \brief Total number of workers from a home unit */
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        unsigned int total ( const int a_from /*!< home unit */ ) const
+        {
+            return (offsets[a_from+1] > offsets[a_from]) ? cumulative[offsets[a_from+1]-1] : 0;
+        }
+
+        /*! \brief Work unit of worker a_irnd (< total(a_from)) from a home unit: the first entry
+                   whose cumulative number exceeds a_irnd, found by binary search */
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        int destination ( const int a_from, /*!< home unit */
+                          const unsigned int a_irnd /*!< worker index */ ) const
+        {
+            int lo = offsets[a_from];
+            int hi = offsets[a_from+1] - 1;
+            while (lo < hi) {
+                const int mid = lo + (hi - lo)/2;
+                if (cumulative[mid] > a_irnd) { hi = mid; }
+                else                          { lo = mid + 1; }
+            }
+            return to[lo];
+        }
+    };
+}
+
 namespace ExaEpi
 {
 namespace Initialization
@@ -26,18 +75,18 @@ namespace Initialization
     /*! \brief Read worker flow data from file and set work location for agents
 
      *  Read in worker flow (home and work) data from a given binary file:
-     *  + Initialize and allocate space for the worker-flow matrix with #DemographicData::Nunit rows
-     *    and columns; note that only those rows are allocated where part of the unit resides on this
-     *    processor.
      *  + Read worker flow data from #ExaEpi::TestParams::workerflow_filename: it is a binary file that
      *    contains 3 x (number of work patthers) unsigned integer data. The 3 integers are: from, to,
      *    and the number of workers with this from and to. The from and to are the IDs from the
      *    first column of the census data file (#DemographicData::myID).
-     *  + For each work pattern: Read in the from, to, and number. If both the from and to ID values
-     *    correspond to units that are on this processor, say, i and j, then set the worker-flow
-     *    matrix element at [i][j] to the number. Note that DemographicData::myIDtoUnit() maps from
-     *    ID value to unit number (from -> i, to -> j).
-     *  + Comvert values in each row to row-wise cumulative values.
+     *  + For each work pattern: Read in the from, to, and number. If the from ID value corresponds
+     *    to a unit that is on this processor, say, i, and the to ID value to a unit with
+     *    communities, say, j, then keep the record (the last one, for a given i and j). Note that
+     *    DemographicData::myIDtoUnit() maps from ID value to unit number (from -> i, to -> j).
+     *  + Build a sparse (CSR) worker-flow table from the records, with a row per unit and an entry
+     *    per nonzero flow, so that the memory is proportional to the number of flows (and not to
+     *    the square of the number of units); convert the values in each row to row-wise
+     *    cumulative values.
      *  + Scale these values to account for ~2% of people of vacation/sick leave.
      *  + For each agent (particle) in each box/tile on each processor:
      *    + Get the home (from) unit of the agent from its home cell index (i,j) and the input argument
@@ -47,7 +96,7 @@ namespace Initialization
      *    + Find age group of this agent, and if it is either 18-29 or 30-64, continue with the
      *      following steps.
      *    + Assign a random work destination unit by picking a random number and placing it in the
-     *      row-wise cumulative numbers in the "from" row of the worker flow matrix.
+     *      row-wise cumulative numbers in the "from" row of the worker flow table, by binary search.
      *    + If the "to" unit is same as the "from" unit, then set the work community number same as
      *      the home community number witn 25% probability and some other random community number in
      *      the same unit with 75% probability.
@@ -63,16 +112,6 @@ namespace Initialization
                           AgentContainer& pc            /*!< Agent container (particle container) */ )
     {
 
-    /* Allocate worker-flow matrix, only from units with nighttime
-     communities on this processor (Unit_on_proc[] flag) */
-    unsigned int** flow = (unsigned int **) amrex::The_Arena()->alloc(demo.Nunit*sizeof(unsigned int *));
-    for (int i = 0; i < demo.Nunit; i++) {
-        if (demo.Unit_on_proc[i]) {
-            flow[i] = (unsigned int *) amrex::The_Arena()->alloc(demo.Nunit*sizeof(unsigned int));
-            for (int j = 0; j < demo.Nunit; j++) flow[i][j] = 0;
-        }
-    }
-
     VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
 
     std::ifstream ifs;
@@ -90,6 +129,9 @@ namespace Initialization
 
     ifs.seekg(CURPOS, std::ios::beg);
 
+    /* Keep the records from units with nighttime communities on this processor
+       (Unit_on_proc[] flag) */
+    std::vector<FlowRecord> records;
     for (int work = 0; work < num_work; ++work) {
         unsigned int from, to, number;
         ifs.read((char*)&from, sizeof(from));
@@ -101,35 +143,63 @@ namespace Initialization
             if (to > 65334) {continue;}
             int j = demo.myIDtoUnit[to];
             if (demo.Start[j+1] != demo.Start[j]) { // if there are communities in this unit
-                flow[i][j] = number;
+                records.push_back(FlowRecord{i, j, number});
             }
         }
     }
 
-    /* Convert to cumulative numbers to enable random selection */
-    for (int i = 0; i < demo.Nunit; i++) {
-        if (demo.Unit_on_proc[i]) {
-            for (int j = 1; j < demo.Nunit; j++) {
-                flow[i][j] += flow[i][j-1];
-            }
+    /* Sort the records by home and work unit; the last record of a pair in the file is used */
+    std::stable_sort(records.begin(), records.end(),
+                     [] (const FlowRecord& a, const FlowRecord& b) {
+                         return (a.from < b.from) || ((a.from == b.from) && (a.to < b.to));
+                     });
+
+    std::vector<int> h_offsets(demo.Nunit+1, 0);
+    std::vector<int> h_to;
+    std::vector<unsigned int> h_cumulative;
+    for (std::size_t r = 0; r < records.size(); ++r) {
+        if (    (r+1 < records.size())
+             && (records[r+1].from == records[r].from) && (records[r+1].to == records[r].to) ) {
+            continue;
         }
+        if (records[r].number == 0) { continue; }
+        h_to.push_back(records[r].to);
+        h_cumulative.push_back(records[r].number);
+        h_offsets[records[r].from+1]++;
+    }
+    for (int i = 0; i < demo.Nunit; i++) {
+        h_offsets[i+1] += h_offsets[i];
     }
 
-    /* These numbers were for the true population, and do not include
-       the roughly 2% of people who were on vacation or sick during the
-       Census 2000 reporting week.  We need to scale the worker flow to
-       the model tract residential populations, and might as well add
-       the 2% back in while we're at it.... */
     for (int i = 0; i < demo.Nunit; i++) {
-        if (demo.Unit_on_proc[i] && demo.Population[i]) {
+        /* Convert to cumulative numbers to enable random selection */
+        for (int k = h_offsets[i]+1; k < h_offsets[i+1]; k++) {
+            h_cumulative[k] += h_cumulative[k-1];
+        }
+
+        /* These numbers were for the true population, and do not include
+           the roughly 2% of people who were on vacation or sick during the
+           Census 2000 reporting week.  We need to scale the worker flow to
+           the model tract residential populations, and might as well add
+           the 2% back in while we're at it.... */
+        if (demo.Population[i]) {
             unsigned int number = (unsigned int) rint(((double) demo.Population[i]) / 2000.0);
             double scale = 1.02 * (2000.0 * number) / ((double) demo.Population[i]);
-            for (int j = 0; j < demo.Nunit; j++) {
-                flow[i][j] = (unsigned int) rint((double) flow[i][j] * scale);
+            for (int k = h_offsets[i]; k < h_offsets[i+1]; k++) {
+                h_cumulative[k] = (unsigned int) rint((double) h_cumulative[k] * scale);
             }
         }
     }
 
+    Gpu::DeviceVector<int> d_offsets(h_offsets.size());
+    Gpu::DeviceVector<int> d_to(h_to.size());
+    Gpu::DeviceVector<unsigned int> d_cumulative(h_cumulative.size());
+    Gpu::copyAsync(Gpu::hostToDevice, h_offsets.begin(), h_offsets.end(), d_offsets.begin());
+    Gpu::copyAsync(Gpu::hostToDevice, h_to.begin(), h_to.end(), d_to.begin());
+    Gpu::copyAsync(Gpu::hostToDevice, h_cumulative.begin(), h_cumulative.end(), d_cumulative.begin());
+    Gpu::streamSynchronize();
+    const WorkerFlowTable flow{d_offsets.data(), d_to.data(), d_cumulative.data()};
+
     const Box& domain = pc.Geom(0).Domain();
 
     /* This is where workplaces should be assigned */
@@ -140,7 +210,7 @@ namespace Initialization
     {
         auto& agents_tile = pc.GetParticles(0)[std::make_pair(mfi.index(),mfi.LocalTileIndex())];
         auto& soa = agents_tile.GetStructOfArrays();
-        auto age_group_ptr = soa.GetIntData(IntIdx::age_group).data();
+        auto traits_ptr = soa.GetIntData(IntIdx::traits).data();
         auto home_i_ptr = soa.GetIntData(IntIdx::home_i).data();
         auto home_j_ptr = soa.GetIntData(IntIdx::home_j).data();
         auto work_i_ptr = soa.GetIntData(IntIdx::work_i).data();
@@ -149,6 +219,8 @@ namespace Initialization
         auto workgroup_ptr = soa.GetIntData(IntIdx::workgroup).data();
         auto work_nborhood_ptr = soa.GetIntData(IntIdx::work_nborhood).data();
         auto np = soa.numParticles();
+        auto pstruct = agents_tile.GetArrayOfStructs()().data();
+        const bool counter_rng = pc.counterRNG();
 
         auto unit_arr = unit_mf[mfi].array();
         auto comm_arr = comm_mf[mfi].array();
@@ -157,7 +229,6 @@ namespace Initialization
         auto Start = demo.Start_d.data();
         auto Ndaywork = demo.Ndaywork_d.data();
         auto Ncommunity = demo.Ncommunity;
-        auto Nunit = demo.Nunit;
 
         amrex::ParallelForRNG( np,
             [=] AMREX_GPU_DEVICE (int ip, RandomEngine const& engine) noexcept
@@ -169,24 +240,25 @@ namespace Initialization
                 unsigned int nwork = (unsigned int) (2000.0 * number * .586); /* 58.6% of population is working-age */
                 if (nwork == 0) { return; }
 
-                int age_group = age_group_ptr[ip];
+                int age_group = AgentTraits::age_group::get(traits_ptr[ip]);
                 /* Check working-age population */
                 if ((age_group == 2) || (age_group == 3)) {
-                    unsigned int irnd = amrex::Random_int(nwork, engine);
+                    AgentRNG rng = counter_rng ? AgentRNG(agentKey(pstruct[ip]), 0, RNGStream::workerflow, 0)
+                                               : AgentRNG(engine);
+                    unsigned int irnd = rng.random_int(nwork);
                     int to = 0;
                     int comm_to = 0;
-                    if (irnd < flow[from][Nunit-1]) {
+                    if (irnd < flow.total(from)) {
                         /* Choose a random destination unit */
-                        to = 0;
-                        while (irnd >= flow[from][to]) { to++; }
+                        to = flow.destination(from, irnd);
                     }
 
                     /*If from=to unit, 25% EXTRA chance of working in home community*/
-                    if ((from == to) && (amrex::Random(engine) < 0.25)) {
+                    if ((from == to) && (rng.random() < 0.25)) {
                         comm_to = comm_arr(home_i_ptr[ip], home_j_ptr[ip], 0);
                     } else {
                         /* Choose a random community within that destination unit */
-                        comm_to = Start[to] + amrex::Random_int(Start[to+1] - Start[to], engine);
+                        comm_to = Start[to] + rng.random_int(Start[to+1] - Start[to]);
                         AMREX_ALWAYS_ASSERT(comm_to < Ncommunity);
                     }
 
@@ -198,14 +270,15 @@ namespace Initialization
                     number = (unsigned int) rint( ((Real) Ndaywork[to]) /
                              ((Real) WG_size * (Start[to+1] - Start[to])) );
 
-                    work_nborhood_ptr[ip]=4*(amrex::Random_int(4, engine))+nborhood_ptr[ip];
+                    work_nborhood_ptr[ip]=4*(rng.random_int(4))+nborhood_ptr[ip];
 
                     if (number) {
-                        workgroup_ptr[ip] = 1 + amrex::Random_int(number, engine);
+                        workgroup_ptr[ip] = 1 + rng.random_int(number);
                     }
                 }
             });
         }
+        Gpu::synchronize();
     }
 
     /*! \brief Infect agents in a random community in a given unit and return the total
@@ -235,7 +308,10 @@ namespace Initialization
                                   const DemographicData& demo, /*!< Demographic data */
                                   int unit, /*!< Unit number to infect */
                                   const int d_idx, /*!< Disease index */
-                                  int ninfect /*!< Target number of agents to infect */ ) {
+                                  int ninfect, /*!< Target number of agents to infect */
+                                  const int pick /*!< Number of earlier calls for this disease; keys the
+                                                      counter-based generator, so that a community
+                                                      picked again draws different agents */ ) {
         // chose random community
         int ncomms = demo.Ncommunity;
         int comm_offset = 0;
@@ -278,20 +354,18 @@ namespace Initialization
             auto offsets = bins.offsetsPtr();
 
             int i_RT = IntIdx::nattribs;
-            int r_RT = RealIdx::nattribs;
-
-            auto status_ptr = soa.GetIntData(i_RT+i0(d_idx)+IntIdxDisease::status).data();
 
-            auto counter_ptr           = soa.GetRealData(r_RT+r0(d_idx)+RealIdxDisease::disease_counter).data();
-            auto incubation_period_ptr = soa.GetRealData(r_RT+r0(d_idx)+RealIdxDisease::incubation_period).data();
-            auto infectious_period_ptr = soa.GetRealData(r_RT+r0(d_idx)+RealIdxDisease::infectious_period).data();
-            auto symptomdev_period_ptr = soa.GetRealData(r_RT+r0(d_idx)+RealIdxDisease::symptomdev_period).data();
+            auto state_ptr    = soa.GetIntData(i_RT+i0(d_idx)+IntIdxDisease::state).data();
+            auto clock_ptr    = soa.GetIntData(i_RT+i0(d_idx)+IntIdxDisease::clock).data();
+            auto schedule_ptr = soa.GetIntData(i_RT+i0(d_idx)+IntIdxDisease::schedule).data();
 
             //auto unit_arr = unit_mf[mfi].array();
             auto comm_arr = comm_mf[mfi].array();
             auto bx = mfi.tilebox();
 
             const auto* lparm = pc.getDiseaseParameters_d(d_idx);
+            const bool counter_rng = pc.counterRNG();
+            const auto key = (static_cast<std::uint64_t>(pick) << 32) | static_cast<std::uint64_t>(random_comm);
 
             Gpu::DeviceScalar<int> num_infected_d(num_infected);
             int* num_infected_p = num_infected_d.dataPtr();
@@ -299,6 +373,8 @@ namespace Initialization
             {
                 int community = comm_arr(i, j, k);
                 if (community != random_comm) { return; }
+                AgentRNG rng = counter_rng ? AgentRNG(key, 0, RNGStream::initial_cases, d_idx)
+                                           : AgentRNG(engine);
 
                 Box tbx;
                 int i_cell = getTileIndex({AMREX_D_DECL(i, j, k)}, box, true, bin_size, tbx);
@@ -314,21 +390,22 @@ namespace Initialization
                 int ni = 0;
                 /*unsigned*/ int stop = std::min(cell_start + ninfect, cell_stop);
                 for (/*unsigned*/ int ip = cell_start; ip < stop; ++ip) {
-                    int ind = cell_start + amrex::Random_int(num_this_community, engine);
+                    int ind = cell_start + rng.random_int(num_this_community);
                     auto pindex = inds[ind];
-                    if (status_ptr[pindex] == Status::infected
-                        || status_ptr[pindex] == Status::immune) {
+                    if (DiseaseState::status::get(state_ptr[pindex]) == Status::infected
+                        || DiseaseState::status::get(state_ptr[pindex]) == Status::immune) {
                         if (++ntry < 100) {
                             --ip;
                         } else {
                             ip += ninfect;
                         }
                     } else {
-                        status_ptr[pindex] = Status::infected;
-                        counter_ptr[pindex] = 0;
-                        incubation_period_ptr[pindex] = amrex::RandomNormal(lparm->incubation_length_mean, lparm->incubation_length_std, engine);
-                        infectious_period_ptr[pindex] = amrex::RandomNormal(lparm->infectious_length_mean, lparm->infectious_length_std, engine);
-                        symptomdev_period_ptr[pindex] = amrex::RandomNormal(lparm->symptomdev_length_mean, lparm->symptomdev_length_std, engine);
+                        DiseaseState::status::set(state_ptr[pindex], Status::infected);
+                        auto incubation_period = static_cast<ParticleReal>(rng.random_normal(lparm->incubation_length_mean, lparm->incubation_length_std));
+                        auto infectious_period = static_cast<ParticleReal>(rng.random_normal(lparm->infectious_length_mean, lparm->infectious_length_std));
+                        auto symptomdev_period = static_cast<ParticleReal>(rng.random_normal(lparm->symptomdev_length_mean, lparm->symptomdev_length_std));
+                        startDiseaseClock(clock_ptr[pindex], schedule_ptr[pindex], incubation_period, infectious_period,
+                                          symptomdev_period, lparm->nearest_day_rounding);
                         ++ni;
                     }
                 }
@@ -375,6 +452,7 @@ namespace Initialization
             amrex::Print() << "Initializing infections for " << d_names[d] << "\n";
             int ntry = 5;
             int ninf = 0;
+            int npick = 0;
             for (int ihub = 0; ihub < cases[d].N_hubs; ++ihub) {
                 if (cases[d].Size_hubs[ihub] > 0) {
                     int FIPS = cases[d].FIPS_hubs[ihub];
@@ -387,7 +465,8 @@ namespace Initialization
                         int u=0;
                         int i=0;
                         while (i < cases[d].Size_hubs[ihub]) {
-                            int nSuccesses= infect_random_community(pc, unit_mf, FIPS_mf, comm_mf, bin_map, demo, units[u], d, ntry);
+                            int nSuccesses= infect_random_community(pc, unit_mf, FIPS_mf, comm_mf, bin_map, demo, units[u], d, ntry,
+                                                                    npick++);
                             ninf += nSuccesses;
                             i+= nSuccesses;
                             u=(u+1)%units.size(); //sometimes we infect fewer than ntry, but switch to next unit anyway
@@ -417,10 +496,11 @@ namespace Initialization
             amrex::Print() << "Initializing infections for " << d_names[d] << "\n";
 
             int ninf = 0;
+            int npick = 0;
             for (int ihub = 0; ihub < num_cases[d]; ++ihub) {
                 int i = 0;
                 while (i < 1) {
-                    int nSuccesses= infect_random_community(pc, unit_mf, FIPS_mf, comm_mf, bin_map, demo, -1, d, 1);
+                    int nSuccesses= infect_random_community(pc, unit_mf, FIPS_mf, comm_mf, bin_map, demo, -1, d, 1, npick++);
                     ninf += nSuccesses;
                     i+= nSuccesses;
                 }
@@ -101,10 +101,28 @@ void ExaEpi::Utils::get_test_params (   TestParams& params,         /*!< Test pa
     if (params.aggregated_diag_int >= 0) {
         pp.get("aggregated_diag_prefix", params.aggregated_diag_prefix);
     }
+    params.aggregated_diag_format = "text";
+    pp.query("aggregated_diag_format", params.aggregated_diag_format);
+    if ((params.aggregated_diag_format != "text") && (params.aggregated_diag_format != "binary")) {
+        amrex::Abort("aggregated_diag_format type not recognized");
+    }
 
     pp.query("shelter_start",  params.shelter_start);
     pp.query("shelter_length", params.shelter_length);
 
+    params.sort_int = 0;
+    pp.query("sort_int", params.sort_int);
+
+    params.chk_int = -1;
+    pp.query("chk_int", params.chk_int);
+    params.chk_prefix = "chk";
+    pp.query("chk_prefix", params.chk_prefix);
+    params.restart = "";
+    pp.query("restart", params.restart);
+
+    params.population_cache = "";
+    pp.query("population_cache", params.population_cache);
+
     Long seed = 0;
     bool reset_seed = pp.query("seed", seed);
     if (reset_seed) {
@@ -8,6 +8,7 @@
 #include <AMReX_MultiFab.H>
 
 #include "AgentContainer.H"
+#include "AggregationCube.H"
 #include "CaseData.H"
 #include "DemographicData.H"
 #include "Initialization.H"
@@ -63,16 +64,27 @@ int main (int argc, /*!< Number of command line arguments */
     + Initialize agents (AgentContainer::initAgentsDemo or AgentContainer::initAgentsCensus).
       If ExaEpi::TestParams::ic_type is ExaEpi::ICType::Census, then
       + Read worker flow (ExaEpi::Initialization::read_workerflow)
+      + If #ExaEpi::TestParams::population_cache is set, the agents created by the two steps
+        above are read from the population cache instead, if it exists, or written to it
+        (ExaEpi::IO::readPopulationCache(), ExaEpi::IO::writePopulationCache())
       + Initialize cases (ExaEpi::Initialization::setInitialCases)
 
+      If restarting (#ExaEpi::TestParams::restart), read the agents, the MultiFabs, and the
+      state of the main loop from the checkpoint instead (ExaEpi::IO::readCheckpoint()).
+    + Sort agents in memory (AgentContainer::sortAgents()), unless #ExaEpi::TestParams::sort_int < 0.
+
 
     \b Evolution
-    At each step from 0 to #ExaEpi::TestParams::nsteps-1:
+    At each step from 0 (or the restart step) to #ExaEpi::TestParams::nsteps-1:
     + IO:
       + if the current step number is a multiple of #ExaEpi::TestParams::plot_int, then write
         out plot file - see ExaEpi::IO::writePlotFile()
       + if current step number is a multiple of #ExaEpi::TestParams::aggregated_diag_int, then write
         out aggregated diagnostic data - see ExaEpi::IO::writeFIPSData().
+      + if the current step number is a multiple of diag.cube_int, then write out the
+        aggregation cube - see ExaEpi::IO::AggregationCube.
+    + If the current step number is a positive multiple of #ExaEpi::TestParams::sort_int, sort
+      agents in memory - see AgentContainer::sortAgents().
     + Agents behavior:
       + Update agent #Status based on their age, number of days since infection, hospitalization,
         etc. - see AgentContainer::updateStatus().
@@ -81,8 +93,11 @@ int main (int argc, /*!< Number of command line arguments */
       + Move agents to home - see AgentContainer::moveAgentsToHome().
       + Let agents interact at home - see AgentContainer::interactAgentsHomeWork().
       + Infect agents based on their movements during the day - see AgentContainer::infectAgents().
-    + Get disease statistics counts - see AgentContainer::printTotals() - and update the
-      peak number of infections and cumulative deaths.
+    + Get disease statistics counts - see AgentContainer::getDailySummary() - and update the
+      peak number of infections and cumulative deaths. The counts are written to the output
+      files by a background thread - see ExaEpi::IO::DailySummaryWriter.
+    + If the number of steps done is a multiple of #ExaEpi::TestParams::chk_int, write a
+      checkpoint - see ExaEpi::IO::writeCheckpoint().
 
     \b Finalize
     + Report peak infections, day of peak infections, and cumulative deaths.
@@ -106,7 +121,8 @@ void runAgent ()
     std::vector<CaseData> cases;
     cases.resize(params.num_diseases);
     for (int d = 0; d < params.num_diseases; d++) {
-        if (params.ic_type == ICType::Census && params.initial_case_type[d] == "file") {
+        if (    params.ic_type == ICType::Census && params.initial_case_type[d] == "file"
+             && params.restart.empty() ) {
             cases[d].InitFromFile(params.disease_names[d],params.case_filename[d]);
         }
     }
@@ -138,39 +154,12 @@ void runAgent ()
     ParmParse pp("diag");
     pp.queryarr("output_filename",output_filename,0,params.num_diseases);
 
-    for (int d = 0; d < params.num_diseases; d++) {
-        if (ParallelDescriptor::IOProcessor())
-        {
-            std::ofstream File;
-            File.open(output_filename[d].c_str(), std::ios::out|std::ios::trunc);
-
-            if (!File.good()) {
-                amrex::FileOpenFailed(output_filename[d]);
-            }
-
-            File << std::setw(5) << "Day"
-                 << std::setw(10) << "Never"
-                 << std::setw(10) << "Infected"
-                 << std::setw(10) << "Immune"
-                 << std::setw(10) << "Deaths"
-                 << std::setw(15) << "Hospitalized"
-                 << std::setw(15) << "Ventilated"
-                 << std::setw(10) << "ICU"
-                 << std::setw(10) << "Exposed"
-                 << std::setw(15) << "Asymptomatic"
-                 << std::setw(15) << "Presymptomatic"
-                 << std::setw(15) << "Symptomatic\n";
-
-            File.flush();
-
-            File.close();
-
-            if (!File.good()) {
-                amrex::Abort("problem writing output file");
-            }
-        }
-    }
-
+    std::string output_format = "text";
+    int output_flush_int = 10;
+    bool async_output = true;
+    pp.query("output_format", output_format);
+    pp.query("output_flush_int", output_flush_int);
+    pp.query("async_output", async_output);
     iMultiFab num_residents(ba, dm, 6, 0);
     iMultiFab unit_mf(ba, dm, 1, 0);
     iMultiFab FIPS_mf(ba, dm, 2, 0);
@@ -188,13 +177,23 @@ void runAgent ()
 
     AgentContainer pc(geom, dm, ba, params.num_diseases, params.disease_names);
 
+    ExaEpi::IO::CheckpointData chk_data;
     {
         BL_PROFILE_REGION("Initialization");
-        if (params.ic_type == ICType::Demo) {
+        if (!params.restart.empty()) {
+            ExaEpi::IO::readCheckpoint(pc, num_residents, unit_mf, FIPS_mf, comm_mf, disease_stats,
+                                       demo, params.disease_names, chk_data, params.restart);
+        } else if (params.ic_type == ICType::Demo) {
             pc.initAgentsDemo(num_residents, unit_mf, FIPS_mf, comm_mf, demo);
         } else if (params.ic_type == ICType::Census) {
-            pc.initAgentsCensus(num_residents, unit_mf, FIPS_mf, comm_mf, demo);
-            ExaEpi::Initialization::read_workerflow(demo, params, unit_mf, comm_mf, pc);
+            const std::string cache = ExaEpi::IO::populationCacheName(params);
+            if (!ExaEpi::IO::readPopulationCache(pc, num_residents, unit_mf, FIPS_mf, comm_mf, demo, cache)) {
+                pc.initAgentsCensus(num_residents, unit_mf, FIPS_mf, comm_mf, demo);
+                ExaEpi::Initialization::read_workerflow(demo, params, unit_mf, comm_mf, pc);
+                if (!cache.empty()) {
+                    ExaEpi::IO::writePopulationCache(pc, num_residents, unit_mf, FIPS_mf, comm_mf, cache);
+                }
+            }
             if (params.initial_case_type[0] == "file") {
                 ExaEpi::Initialization::setInitialCasesFromFile( pc,
                                                                  unit_mf,
@@ -213,24 +212,52 @@ void runAgent ()
                                                                 demo );
             }
         }
+        if (params.sort_int >= 0) {
+            pc.sortAgents();
+        }
+    }
+
+    ExaEpi::IO::AggregationCube cube(demo, params.ic_type == ICType::Census);
+
+    // the infections are not fused with the status update of a day whose diagnostics are
+    // written, since these show the agents before the update
+    auto writesDiagnostics = [&] (const int a_day) -> bool {
+        return    ((params.plot_int > 0) && (a_day % params.plot_int == 0))
+               || ((params.aggregated_diag_int > 0) && (a_day % params.aggregated_diag_int == 0))
+               || cube.writeOnDay(a_day);
+    };
+
+    ExaEpi::IO::DailySummaryWriter output_writer(output_filename, output_format, output_flush_int,
+                                                 async_output, chk_data.step);
+    if (    !params.restart.empty() && (params.aggregated_diag_int > 0)
+         && (params.aggregated_diag_format == "binary") ) {
+        ExaEpi::IO::trimFIPSData(params.aggregated_diag_prefix, demo, params.num_diseases, chk_data.step);
     }
 
     std::vector<int>  step_of_peak(params.num_diseases, 0);
     std::vector<Long> num_infected_peak(params.num_diseases, 0);
     std::vector<Long> cumulative_deaths(params.num_diseases, 0);
-    for (int d = 0; d < params.num_diseases; d++) {
-        auto counts = pc.getTotals(d);
-        if (counts[1] > num_infected_peak[d]) {
-            num_infected_peak[d] = counts[1];
-            step_of_peak[d] = 0;
+    if (!params.restart.empty()) {
+        step_of_peak = chk_data.step_of_peak;
+        num_infected_peak = chk_data.num_infected_peak;
+        cumulative_deaths = chk_data.cumulative_deaths;
+    } else {
+        auto summary = pc.getDailySummary(disease_stats);
+        for (int d = 0; d < params.num_diseases; d++) {
+            const auto& counts = summary[d].counts;
+            if (counts[1] > num_infected_peak[d]) {
+                num_infected_peak[d] = counts[1];
+                step_of_peak[d] = 0;
+            }
+            cumulative_deaths[d] = counts[4];
         }
-        cumulative_deaths[d] = counts[4];
     }
 
-    amrex::Real cur_time = 0;
+    amrex::Real cur_time = chk_data.cur_time;
+    bool status_updated = chk_data.status_updated;
     {
         BL_PROFILE_REGION("Evolution");
-        for (int i = 0; i < params.nsteps; ++i)
+        for (int i = chk_data.step; i < params.nsteps; ++i)
         {
             amrex::Print() << "Simulating day " << i << "\n";
 
@@ -253,65 +280,38 @@ void runAgent ()
                                             comm_mf,
                                             demo,
                                             params.aggregated_diag_prefix,
+                                            params.aggregated_diag_format,
                                             params.num_diseases,
                                             params.disease_names,
                                             i );
             }
 
-            // Update agents' disease status
-            pc.updateStatus(disease_stats);
+            if (cube.writeOnDay(i)) {
+                cube.write(pc, unit_mf, params.disease_names, i);
+            }
+
+            if ((params.sort_int > 0) && (i > 0) && (i % params.sort_int == 0)) {
+                pc.sortAgents();
+            }
+
+            // Update agents' disease status (already done at the end of the previous day if
+            // fused with the infections)
+            if (!status_updated) {
+                pc.updateStatus(disease_stats);
+            }
+
+            // Daily summary of all diseases, with a single reduction
+            auto summary = pc.getDailySummary(disease_stats);
 
             for (int d = 0; d < params.num_diseases; d++) {
-                auto counts = pc.getTotals(d);
+                const auto& counts = summary[d].counts;
+                const auto& mmc = summary[d].stats;
                 if (counts[1] > num_infected_peak[d]) {
                     num_infected_peak[d] = counts[1];
                     step_of_peak[d] = i;
                 }
                 cumulative_deaths[d] = counts[4];
 
-                Real mmc[4] = {0, 0, 0, 0};
-#ifdef AMREX_USE_GPU
-                if (Gpu::inLaunchRegion()) {
-                    auto const& ma = disease_stats[d]->const_arrays();
-                    GpuTuple<Real,Real,Real,Real> mm = ParReduce(
-                             TypeList<ReduceOpSum,ReduceOpSum,ReduceOpSum,ReduceOpSum>{},
-                             TypeList<Real,Real,Real,Real>{},
-                             *(disease_stats[d]), IntVect(0, 0),
-                             [=] AMREX_GPU_DEVICE (int box_no, int ii, int jj, int kk) noexcept
-                             -> GpuTuple<Real,Real,Real,Real>
-                             {
-                                 return { ma[box_no](ii,jj,kk,0),
-                                          ma[box_no](ii,jj,kk,1),
-                                          ma[box_no](ii,jj,kk,2),
-                                          ma[box_no](ii,jj,kk,3) };
-                             });
-                    mmc[0] = amrex::get<0>(mm);
-                    mmc[1] = amrex::get<1>(mm);
-                    mmc[2] = amrex::get<2>(mm);
-                    mmc[3] = amrex::get<3>(mm);
-                } else
-#endif
-                    {
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (!system::regtest_reduction) reduction(+:mmc[:4])
-#endif
-                        for (MFIter mfi(*(disease_stats[d]),true); mfi.isValid(); ++mfi)
-                        {
-                            Box const& bx = mfi.tilebox();
-                            auto const& dfab = disease_stats[d]->const_array(mfi);
-                            AMREX_LOOP_3D(bx, ii, jj, kk,
-                            {
-                                mmc[0] += dfab(ii,jj,kk,0);
-                                mmc[1] += dfab(ii,jj,kk,1);
-                                mmc[2] += dfab(ii,jj,kk,2);
-                                mmc[3] += dfab(ii,jj,kk,3);
-                            });
-                        }
-                    }
-
-                ParallelDescriptor::ReduceRealSum(&mmc[0], 4,
-                                                  ParallelDescriptor::IOProcessorNumber());
-
                 if (ParallelDescriptor::IOProcessor())
                 {
                     // total number of deaths computed on agents and on mesh should be the same...
@@ -326,37 +326,12 @@ void runAgent ()
                     //     infectious and pre-symptomatic
                     //     infectious and symptomatic
                     AMREX_ALWAYS_ASSERT(counts[1] == counts[5] + counts[6] + counts[7] + counts[8]);
-
-                    std::ofstream File;
-                    File.open(output_filename[d].c_str(), std::ios::out|std::ios::app);
-
-                    if (!File.good()) {
-                        amrex::FileOpenFailed(output_filename[d]);
-                    }
-
-                    File << std::setw(5) << i
-                         << std::setw(10) << counts[0]
-                         << std::setw(10) << counts[1]
-                         << std::setw(10) << counts[2]
-                         << std::setw(10) << counts[4]
-                         << std::setw(15) << mmc[0]
-                         << std::setw(15) << mmc[1]
-                         << std::setw(10) << mmc[2]
-                         << std::setw(10) << counts[5]
-                         << std::setw(15) << counts[6]
-                         << std::setw(15) << counts[7]
-                         << std::setw(15) << counts[8] << "\n";
-
-                    File.flush();
-
-                    File.close();
-
-                    if (!File.good()) {
-                        amrex::Abort("problem writing output file");
-                    }
                 }
             }
 
+            // Written by a background thread with asynchronous output
+            output_writer.write(i, summary);
+
             if (params.shelter_start > 0 && params.shelter_start == i) {
                 pc.shelterStart();
             }
@@ -373,7 +348,12 @@ void runAgent ()
             pc.interactNight(mask_behavior);
 
             // Infect agents based on their interactions
-            pc.infectAgents();
+            status_updated = pc.fuseInfectUpdate() && (i+1 < params.nsteps) && !writesDiagnostics(i+1);
+            if (status_updated) {
+                pc.infectAndUpdateStatus(disease_stats);
+            } else {
+                pc.infectAgents();
+            }
 
             //            if ((params.random_travel_int > 0) && (i % params.random_travel_int == 0)) {
             //                pc.moveRandomTravel();
@@ -381,8 +361,17 @@ void runAgent ()
             //            pc.Redistribute();
 
             cur_time += 1.0_rt; // time step is one day
+
+            if ((params.chk_int > 0) && ((i+1) % params.chk_int == 0) && (i+1 < params.nsteps)) {
+                output_writer.flush();
+                chk_data = ExaEpi::IO::CheckpointData{i+1, cur_time, status_updated,
+                                                      step_of_peak, num_infected_peak, cumulative_deaths};
+                ExaEpi::IO::writeCheckpoint(pc, num_residents, unit_mf, FIPS_mf, comm_mf, disease_stats,
+                                            params.disease_names, chk_data, params.chk_prefix);
+            }
         }
     }
+    output_writer.finalize();
 
     if (params.num_diseases == 1) {
         amrex::Print() << "\n \n";
@@ -420,6 +409,7 @@ void runAgent ()
                                     comm_mf,
                                     demo,
                                     params.aggregated_diag_prefix,
+                                    params.aggregated_diag_format,
                                     params.num_diseases,
                                     params.disease_names,
                                     params.nsteps);